@@ -0,0 +1,254 @@
+#include "CatPool.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file CatPool.cpp
+ * @brief Implementation of the CatPool
+ */
+
+ /**
+  * @brief Constructs an empty pool
+  * @param capacity Number of cats that fit without reallocating
+  */
+CatPool::CatPool(int capacity) : slots(capacity) {
+    handles.reserve(capacity);
+    bodyIds.reserve(capacity);
+    halfWidths.reserve(capacity);
+    eaten.reserve(capacity);
+    states.reserve(capacity);
+    posX.reserve(capacity);
+    posY.reserve(capacity);
+    velX.reserve(capacity);
+}
+
+/**
+ * @brief Spawn a new Cat in the Box2D world.
+ * @param worldId Box2D world identifier
+ * @param x Initial x-position
+ * @param y Initial y-position
+ * @return Handle of the new Cat
+ */
+CatHandle CatPool::spawn(b2WorldId worldId, float x, float y) {
+    b2BodyDef bd = b2DefaultBodyDef();
+    bd.position = { x, y };
+    return spawn(worldId, bd);
+}
+
+/**
+ * @brief Spawn a Cat with a given body state, e.g. from a save
+ * @param worldId Box2D world identifier
+ * @param bodyDef Position, rotation, velocity and awake flag of the Cat
+ * @return Handle of the new Cat
+ */
+CatHandle CatPool::spawn(b2WorldId worldId, const b2BodyDef& bodyDef) {
+    const float halfWidth = 2.0f;
+
+    b2BodyDef bd = bodyDef;
+    bd.type = b2_dynamicBody;
+    b2BodyId bodyId = b2CreateBody(worldId, &bd);
+    const float x = bd.position.x;
+    const float y = bd.position.y;
+
+    b2Polygon catBox = b2MakeBox(halfWidth, 0.5f);
+    b2ShapeDef sd = b2DefaultShapeDef();
+    sd.density = 3.0f;
+    sd.filter.categoryBits = CAT_CATEGORY;
+    b2ShapeId s = b2CreatePolygonShape(bodyId, &sd, &catBox);
+    b2Shape_SetFriction(s, 0.3f);
+
+    // Mouth: a massless sensor that reports food touching the cat
+    b2Polygon mouthBox = b2MakeBox(MOUTH_HALF_WIDTH, MOUTH_HALF_HEIGHT);
+    b2ShapeDef mouthDef = b2DefaultShapeDef();
+    mouthDef.density = 0.0f;
+    mouthDef.isSensor = true;
+    mouthDef.enableSensorEvents = true;
+    b2CreatePolygonShape(bodyId, &mouthDef, &mouthBox);
+
+    CatHandle handle = slots.create();
+    slots.get(handle)->index = size();
+    b2Body_SetUserData(bodyId, (void*)(uintptr_t)handle.index);
+
+    handles.push_back(handle);
+    bodyIds.push_back(bodyId);
+    halfWidths.push_back(halfWidth);
+    eaten.push_back(0);
+    states.push_back(CatState::Idle);
+    posX.push_back(x);
+    posY.push_back(y);
+    velX.push_back(0.0f);
+    return handle;
+}
+
+/**
+ * @brief Remove a Cat from the world and the pool
+ * @param handle Cat to remove, stale handles are ignored
+ *
+ * The last Cat is moved into the freed index.
+ */
+void CatPool::destroy(CatHandle handle) {
+    int index = indexOf(handle);
+    if (index < 0) return;
+    b2DestroyBody(bodyIds[index]);
+    slots.destroy(handle);
+
+    int last = size() - 1;
+    handles[index] = handles[last];
+    if (index != last) slots.get(handles[index])->index = index;
+    bodyIds[index] = bodyIds[last];
+    halfWidths[index] = halfWidths[last];
+    eaten[index] = eaten[last];
+    states[index] = states[last];
+    posX[index] = posX[last];
+    posY[index] = posY[last];
+    velX[index] = velX[last];
+
+    handles.pop_back();
+    bodyIds.pop_back();
+    halfWidths.pop_back();
+    eaten.pop_back();
+    states.pop_back();
+    posX.pop_back();
+    posY.pop_back();
+    velX.pop_back();
+}
+
+/**
+ * @brief Forget all cats without touching Box2D (used when the world is destroyed)
+ */
+void CatPool::clear() {
+    slots.clear();
+    handles.clear();
+    bodyIds.clear();
+    halfWidths.clear();
+    eaten.clear();
+    states.clear();
+    posX.clear();
+    posY.clear();
+    velX.clear();
+}
+
+/**
+ * @brief Current index of a Cat in the arrays
+ * @param handle Cat to look up
+ * @return Index, or -1 if the handle is stale
+ */
+int CatPool::indexOf(CatHandle handle) const {
+    const Cat* cat = slots.get(handle);
+    return cat ? cat->index : -1;
+}
+
+/**
+ * @brief Find the Cat owning a Box2D body
+ * @param bodyId Body from a Box2D event
+ * @return Index, or -1 if the body is not a live cat
+ */
+int CatPool::indexOfBody(b2BodyId bodyId) const {
+    CatHandle handle = slots.handleOf((uint32_t)(uintptr_t)b2Body_GetUserData(bodyId));
+    int index = indexOf(handle);
+    if (index < 0 || !B2_ID_EQUALS(bodyIds[index], bodyId)) return -1;
+    return index;
+}
+
+/**
+ * @brief Copy every cat's position out of Box2D into posX/posY
+ */
+void CatPool::gatherPositions() {
+    int n = size();
+    for (int i = 0; i < n; ++i) {
+        b2Vec2 p = b2Body_GetPosition(bodyIds[i]);
+        posX[i] = p.x;
+        posY[i] = p.y;
+    }
+}
+
+/**
+ * @brief Move every Cat toward its target Food while avoiding Poop.
+ * @param targetX X-position of each cat's target, indexed like the pool
+ * @param hasTarget Nonzero for cats that have a target
+ * @param poopX X-positions of all poop, sorted ascending
+ * @param poopCount Number of poop
+ * @param worldWidth Width of the Box2D world
+ *
+ * Expects gatherPositions() to have run this step. Computes all velocities
+ * in loops over the arrays and then hands them back to Box2D. Each cat finds
+ * poop in its way with a binary search, so the cost is cats times log poop.
+ */
+void CatPool::moveToward(const float* targetX, const uint8_t* hasTarget, const float* poopX, int poopCount,
+    float worldWidth) {
+    const float speed = 1.5f;
+    const int n = size();
+    const float* px = posX.data();
+    const float* hw = halfWidths.data();
+    float* vx = velX.data();
+    CatState* st = states.data();
+
+    for (int i = 0; i < n; ++i) {
+        float cx = px[i];
+        float tx = hasTarget[i] ? targetX[i] : cx;
+
+        // Avoid poop if it is between Cat and Food: the first poop right of
+        // the nearer end must lie before the farther one
+        float lo = b2MinFloat(cx, tx), hi = b2MaxFloat(cx, tx);
+        const float* next = std::upper_bound(poopX, poopX + poopCount, lo);
+        bool blocked = next != poopX + poopCount && *next < hi;
+
+        float dx = blocked ? (cx < tx ? -0.5f : 0.5f) : tx - cx;
+
+        float nextX = cx + dx * 0.05f;
+        bool outside = nextX < hw[i] || nextX > worldWidth - hw[i];
+        dx = outside ? 0.0f : dx;
+
+        vx[i] = dx * speed;
+        st[i] = !hasTarget[i] ? CatState::Idle : (blocked ? CatState::Avoiding : CatState::Chasing);
+    }
+
+    for (int i = 0; i < n; ++i)
+        b2Body_SetLinearVelocity(bodyIds[i], { vx[i], 0.0f });
+}
+
+/**
+ * @brief Count a meal for a Cat.
+ * @param index Cat that ate
+ * @return True if the Cat is full and has to poop now
+ *
+ * The meals are kept until resetMeals(), so a Cat that cannot poop yet
+ * tries again with its next meal.
+ */
+bool CatPool::eat(int index) {
+    return ++eaten[index] >= 5;
+}
+
+/**
+ * @brief Start counting meals from zero after a Cat pooped.
+ * @param index Cat that pooped
+ */
+void CatPool::resetMeals(int index) {
+    eaten[index] = 0;
+}
+
+/**
+ * @brief Push a Cat away from the poop it just made so it doesn't stand on it :3
+ * @param index Cat to push
+ * @param worldWidth Width of the Box2D world
+ */
+void CatPool::scootAway(int index, float worldWidth) {
+    float cx = posX[index];
+    float impulse = (cx < worldWidth / 2) ? -450.0f : 450.0f;
+    b2Body_ApplyLinearImpulseToCenter(bodyIds[index], { impulse, 0.0f }, true);
+
+    if (cx < 3.0f)
+        b2Body_SetLinearVelocity(bodyIds[index], { fabsf(impulse) * 0.01f, 0.0f });
+    else if (cx > worldWidth - 3.0f)
+        b2Body_SetLinearVelocity(bodyIds[index], { -fabsf(impulse) * 0.01f, 0.0f });
+}
+
+/**
+ * @brief Copy a Cat's drawable state out of Box2D.
+ * @param index Cat to copy
+ * @return Position, meal counter and state of the Cat
+ */
+CatView CatPool::view(int index) const {
+    b2Vec2 pos = b2Body_GetPosition(bodyIds[index]);
+    return CatView{ pos.x, pos.y, eaten[index], states[index] };
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <box2d/box2d.h>
+#include <cstdint>
+#include <vector>
+#include "Catagotchi.h"
+#include "EntityArena.h"
+
+/**
+ * @file CatPool.h
+ * @brief All cats of a world stored as structure-of-arrays
+ *
+ * Each cat is an index into parallel arrays instead of a heap object, so the
+ * AI runs as batch loops over contiguous floats. The arrays are reserved up
+ * front and cats are removed by swapping with the last one, so spawning and
+ * destroying cats does not allocate until the capacity is exceeded. Since
+ * indices move on removal, cats are referred to from outside by CatHandle.
+ */
+
+class CatPool {
+public:
+    explicit CatPool(int capacity = 1024);
+
+    CatHandle spawn(b2WorldId worldId, float x, float y);
+    CatHandle spawn(b2WorldId worldId, const b2BodyDef& bodyDef);
+    void destroy(CatHandle handle);
+    void clear();
+    int size() const { return (int)bodyIds.size(); }
+    int indexOf(CatHandle handle) const;
+    int indexOfBody(b2BodyId bodyId) const;
+
+    // Cats eat whatever food touches this sensor box around them
+    static constexpr float MOUTH_HALF_WIDTH = 4.0f;
+    static constexpr float MOUTH_HALF_HEIGHT = 2.0f;
+
+    // Collision category of the cat's body shape (not the mouth), so queries
+    // can find each cat once
+    static constexpr uint64_t CAT_CATEGORY = 0x0004;
+
+    void gatherPositions();
+    void moveToward(const float* targetX, const uint8_t* hasTarget, const float* poopX, int poopCount,
+        float worldWidth);
+    bool eat(int index);
+    void resetMeals(int index);
+    void scootAway(int index, float worldWidth);
+
+    CatView view(int index) const;
+
+    // One entry per cat, all arrays have size() elements
+    std::vector<CatHandle> handles;
+    std::vector<b2BodyId> bodyIds;
+    std::vector<float> halfWidths;
+    std::vector<int> eaten;
+    std::vector<CatState> states;
+
+    // Scratch arrays for the batch AI, refreshed every update
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+
+private:
+    EntityArena<Cat> slots;
+};
@@ -1,55 +1,82 @@
 #pragma once
 #include <box2d/box2d.h>
-#include <memory>
+#include <cstdint>
+#include "EntityArena.h"
+#include "FoodBodyPool.h"
+#include "StaticGeometry.h"
+
+class Renderer;
 
 
 /**
  * @file Catagotchi.h
  * @brief Definitions of Cat, Food, and Poop classes
  *
- * This file defines the main game objects with Box2D physics.
+ * This file defines the main game objects with Box2D physics. The cats
+ * themselves live in a CatPool (CatPool.h), a Cat is only the handle slot
+ * pointing into it and knows how to look.
+ * Food and Poop live in EntityArenas and are referred to by handles.
  * Course concepts demonstrated:
- * - Smart pointers (shared_ptr)
+ * - Pooled objects with generational handles
  * - ASCII graphics with PDCurses
  */
 
-struct Food;
-struct Poop;
+enum class CatState : uint8_t {
+    Idle,       // nothing to eat
+    Chasing,    // walking toward food
+    Avoiding,   // poop is in the way
+};
 
-struct Cat {
-    b2BodyId bodyId{};
-    float halfWidth = 2.0f;
+/**
+ * @brief Plain copies of what is needed to draw each object
+ *
+ * Filled by the physics thread so drawing never has to call into Box2D.
+ * What they look like is up to the SpriteAtlas.
+ */
+struct CatView {
+    float x = 0.0f;
+    float y = 0.0f;
     int eaten = 0;
-    const char* sprite = "=^.^=";
+    CatState state = CatState::Idle;
+};
+
+struct FoodView {
+    float x = 0.0f;
+    float y = 0.0f;
+};
 
-    static std::shared_ptr<Cat> spawn(b2WorldId worldId, float x, float y);
+struct PoopView {
+    float x = 0.0f;
+    float y = 0.0f;
+};
 
-    void moveToward(std::shared_ptr<Food> food, std::shared_ptr<Poop> poop, float worldWidth);
-    void tryEat(std::shared_ptr<Food>& food, std::shared_ptr<Poop>& poop, b2WorldId worldId, float worldWidth);
+struct Cat {
+    int index = -1;   // position of this cat in the CatPool arrays
 
-    void draw(int xOffset, int termCols, int termRows);
+    static void draw(const CatView& view, Renderer& renderer);
 };
-using CatPtr = std::shared_ptr<Cat>;
+using CatHandle = Handle<Cat>;
 
 
 struct Food {
     b2BodyId bodyId{};
-    bool active = false;
-    const char* sprite = "*";
 
-    static std::shared_ptr<Food> spawn(b2WorldId worldId, float x, float y);
-    void draw(int xOffset, int termRows);
+    void create(FoodBodyPool& pool, float x, float y);
+    void destroy(FoodBodyPool& pool);
+    FoodView view() const;
+    static void draw(const FoodView& view, Renderer& renderer);
 };
-using FoodPtr = std::shared_ptr<Food>;
+using FoodHandle = Handle<Food>;
 
 
 struct Poop {
-    b2BodyId bodyId{};
-    bool active = false;
+    b2ShapeId shapeId{};
     float x = 0.0f;
-    const char* sprite = "o";
+    float y = 0.0f;
 
-    static std::shared_ptr<Poop> spawn(b2WorldId worldId, const b2Vec2& pos);
-    void draw(int xOffset, int termRows);
+    void create(StaticGeometry& geometry, const b2Vec2& pos);
+    void destroy(StaticGeometry& geometry);
+    PoopView view() const;
+    static void draw(const PoopView& view, Renderer& renderer);
 };
-using PoopPtr = std::shared_ptr<Poop>;
+using PoopHandle = Handle<Poop>;
@@ -0,0 +1,102 @@
+#include "CommandQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/**
+ * @file CommandQueue.cpp
+ * @brief Implementation of the lock-free command queue
+ */
+
+ /**
+  * @brief Constructs an empty queue
+  */
+CommandQueue::CommandQueue() {
+    for (size_t i = 0; i < CAPACITY; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Timestamp and enqueue a command
+ * @param type What the physics thread should do
+ */
+bool CommandQueue::push(CommandType type) {
+    return push(type, now());
+}
+
+/**
+ * @brief Enqueue a command with the time it was issued
+ * @param type What the physics thread should do
+ * @param timestamp Steady clock nanoseconds, see now()
+ */
+bool CommandQueue::push(CommandType type, int64_t timestamp) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & (CAPACITY - 1)];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.command.type = type;
+                cell.command.timestamp = timestamp;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Dequeue the oldest command
+ * @param out Receives the command
+ */
+bool CommandQueue::pop(Command& out) {
+    Cell& cell = cells[head & (CAPACITY - 1)];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(head + 1) < 0) return false;
+
+    out = cell.command;
+    cell.sequence.store(head + CAPACITY, std::memory_order_release);
+    head++;
+    return true;
+}
+
+/**
+ * @brief Current time in the unit of Command::timestamp
+ * @return Steady clock nanoseconds
+ */
+int64_t CommandQueue::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Remember how long a command took from issue to apply
+ * @param command Command that was just applied
+ * @param appliedAt CommandQueue::now() when it was applied
+ */
+void CommandLatencyLog::record(const Command& command, int64_t appliedAt) {
+    latencies[count % CAPACITY] = appliedAt - command.timestamp;
+    count++;
+}
+
+/**
+ * @brief Print latency percentiles of the retained commands
+ * @param out Stream to print to
+ */
+void CommandLatencyLog::report(FILE* out) const {
+    int n = (int)std::min<long long>(count, CAPACITY);
+    if (n == 0) return;
+
+    std::vector<int64_t> sorted(latencies, latencies + n);
+    std::sort(sorted.begin(), sorted.end());
+
+    fprintf(out, "input: %lld commands, input-to-effect p50 %.2f ms, p99 %.2f ms, max %.2f ms (last %d)\n",
+        count, sorted[n / 2] / 1e6, sorted[(n * 99) / 100] / 1e6, sorted[n - 1] / 1e6, n);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @file CommandQueue.h
+ * @brief Commands sent to the physics thread and the queue that carries them
+ *
+ * Only the physics thread ever changes the Box2D world. Everyone else
+ * (input, headless feeder, ...) pushes a Command and the physics thread
+ * applies all pending commands at the start of its next step.
+ */
+
+enum class CommandType : uint8_t {
+    SpawnFood,
+    CleanPoop,
+};
+
+struct Command {
+    CommandType type = CommandType::SpawnFood;
+    int64_t timestamp = 0;   // steady clock nanoseconds when the command was issued
+};
+
+/**
+ * @brief Bounded lock-free multi-producer / single-consumer queue of commands
+ *
+ * Each cell carries a sequence number that tells producers and the consumer
+ * whose turn it is (Vyukov's bounded queue), so push and pop are a single
+ * CAS/store in the common case and never block.
+ */
+class CommandQueue {
+public:
+    static constexpr size_t CAPACITY = 256;   // must be a power of two
+
+    CommandQueue();
+
+    /**
+     * @brief Add a command, safe to call from any thread
+     * @return False if the queue is full and the command was dropped
+     */
+    bool push(CommandType type);
+
+    /**
+     * @brief Add a command issued earlier, e.g. when its key was read
+     * @return False if the queue is full and the command was dropped
+     */
+    bool push(CommandType type, int64_t timestamp);
+
+    /**
+     * @brief Take the oldest command, only the physics thread may call this
+     * @return False if the queue is empty
+     */
+    bool pop(Command& out);
+
+    static int64_t now();
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Command command;
+    };
+
+    Cell cells[CAPACITY];
+    alignas(64) std::atomic<size_t> tail{ 0 };   // producers
+    alignas(64) size_t head = 0;                 // consumer
+};
+
+/**
+ * @brief Issue-to-apply latency of the most recent commands
+ *
+ * Written only by the thread that applies commands, read after it stopped.
+ */
+struct CommandLatencyLog {
+    static constexpr int CAPACITY = 1024;
+
+    int64_t latencies[CAPACITY];   // nanoseconds from issue to apply, oldest overwritten
+    long long count = 0;
+
+    void record(const Command& command, int64_t appliedAt);
+    void report(FILE* out) const;
+};
@@ -8,14 +8,89 @@
   This is a small CatAGotchi demo using C++ with Box2D and PDCurses.
 
   \section tech_sec Techniques from course:
-  - Threads (physics loop in separate thread) (also mutex usage)
-  - Smart pointers (shared_ptr)
+  - Threads (physics loop in a joinable PhysicsService thread, keys read on an InputHandler thread) (also mutex usage)
+  - Pooled objects with generational handles (EntityArena)
   - Box2D physics engine (library)
-  - ASCII graphics with PDCurses (another library)
+  - Cats find food through Box2D's broadphase (FoodTargeting)
+  - ASCII graphics with PDCurses (another library), redrawing only changed cells (Renderer) from sprites pre-built as
+    curses cells (SpriteAtlas)
   - A lambda function in physics loop
+  - Per-frame bump allocation for temporary buffers (FrameArena)
 
   \section usage Usage
   - q = quit
-  - f = add food
-  - c = clean poop (if exists)
+  - f = add food (one pellet per cat at most)
+  - c = clean all poop (if exists)
+  - [ and ] (or Tab) = camera follows the previous / next cat
+  - t = write the trace (with --trace=FILE)
+  - space = pause / resume physics, n = one step while paused
+  - + and - = double / halve the physics step rate (slow motion below 60)
+  - s = save now (with --save=FILE)
+  - p = show/hide the perf overlay: Box2D step stages, body/contact/island
+    counts, render time, input-to-effect latency, Box2D memory and the
+    measured step rate, lag, overruns, step time average and p99 and awake
+    bodies of the physics thread (PerfOverlay, MemoryTracker, PhysicsStats)
+
+  --cols=N and --rows=N make the world bigger than the terminal (default:
+  title width and terminal height), the camera then scrolls along with the
+  selected cat. Only what is in view is copied for drawing, found with
+  b2World_OverlapAABB (GameWorld::snapshot). Worlds narrower than 16
+  columns or too short to drop food onto the cats are rejected.
+
+  --physics-rate=N sets how many fixed steps physics runs per second (default
+  60, real time; 7.5 to 480), a lower rate throttles the simulation under load.
+
+  --fps=N sets the curses game's target frame rate (default 20). Frame
+  counts, frame time percentiles, input-to-effect latency, the physics step
+  rate, overruns and step times, and the heap allocations made by frames
+  and physics steps (HeapCounter, zero once the game has settled) are
+  printed when the game exits.
+
+  \section headless_sec Headless mode
+  Runs the simulation without curses at a fixed step and prints ticks/sec
+  and per-phase timings at exit, along with the world's Box2D memory (live,
+  peak, per cat and allocations per second, see MemoryTracker.h):
+  - --headless --ticks=N    run N physics ticks
+  - --headless --seconds=S  run for S seconds of wall time
+  - --feed=N                auto-feed every N ticks (default 30)
+  - --pellets=N             pellets per auto-feeding (default 1)
+  - --rows=N                world height in rows (default 30)
+  - --cols=N                world width in columns (default title width)
+
+  --workers=N (also in the curses game) runs Box2D's parallel stages on a
+  work-stealing pool of N workers, counting the stepping thread (default 1).
+  --cats=N spawns a colony of N cats (default 1).
+
+  --check=controls runs the physics thread for about a second and checks
+  that pause, stepN and resume step exactly as documented (PhysicsService),
+  exiting with 1 if not.
+
+  \section farm_sec Farm mode
+  --farm=N [--threads=T] runs N independent worlds (at most 128, Box2D's
+  B2_MAX_WORLDS) on T threads and prints world-steps/sec. It takes the
+  headless options for every world. Worlds move between threads to balance
+  the load, see Farm.h.
+
+  \section save_sec Saving pets
+  --save=FILE (curses game and headless) restores the world from FILE if it
+  exists, saves it there every minute in the background and again on exit.
+  See WorldSave.h for the file format.
+
+  \section replay_sec Record and replay
+  - --record=FILE  record the session (curses or headless) to FILE
+  - --seed=N       seed of the food RNG (default: time in the game, 1 headless)
+  - --replay=FILE [--workers=N]  re-run a recording headless as fast as
+    possible and check the world hash after every step (see SessionLog.h)
+
+  \section trace_sec Tracing
+  --trace=FILE (curses game and headless) records begin/end events of the
+  physics step and its Box2D stages, Box2D worker tasks, the render loop,
+  input and saving, and writes them to FILE as Chrome trace JSON at exit.
+  In the game t writes the trace recorded so far. Open the file in
+  chrome://tracing or ui.perfetto.dev, see Trace.h.
+
+  \section bench_sec Benchmarks
+  - --bench=food [--rate=N] [--seconds=S]  food rain at N spawns/sec
+    (default 10000) for S simulated seconds (default 10), once creating and
+    destroying a body per pellet and once with the FoodBodyPool
 */
\ No newline at end of file
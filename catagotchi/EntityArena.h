@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file EntityArena.h
+ * @brief Pooled storage for game objects addressed by generational handles
+ *
+ * A handle is a slot index plus the generation the slot had when the object
+ * was created. Destroying an object bumps the slot's generation, so old
+ * handles to it stop resolving instead of pointing at whatever reuses the
+ * slot. Slots are recycled through a free list and live objects are also
+ * kept in a dense list for fast iteration, so after the initial reserve
+ * creating and destroying objects never touches the heap.
+ */
+
+template <typename T>
+struct Handle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == UINT32_MAX; }
+    bool operator==(const Handle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+template <typename T>
+class EntityArena {
+public:
+    explicit EntityArena(int capacity = 0) {
+        slots.reserve(capacity);
+        generations.reserve(capacity);
+        densePos.reserve(capacity);
+        dense.reserve(capacity);
+        freeList.reserve(capacity);
+    }
+
+    /**
+     * @brief Take a free slot, growing only if every slot is in use
+     * @return Handle of the new, default-constructed object
+     */
+    Handle<T> create() {
+        uint32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+            slots[index] = T{};
+        }
+        else {
+            index = (uint32_t)slots.size();
+            slots.emplace_back();
+            generations.push_back(0);
+            densePos.push_back(0);
+        }
+        densePos[index] = (uint32_t)dense.size();
+        dense.push_back(index);
+        return Handle<T>{ index, generations[index] };
+    }
+
+    /**
+     * @brief Free the object's slot, stale handles are ignored
+     */
+    void destroy(Handle<T> handle) {
+        if (!alive(handle)) return;
+        uint32_t pos = densePos[handle.index];
+        uint32_t moved = dense.back();
+        dense[pos] = moved;
+        densePos[moved] = pos;
+        dense.pop_back();
+        generations[handle.index]++;
+        freeList.push_back(handle.index);
+    }
+
+    /** @brief Destroy everything, all outstanding handles become stale */
+    void clear() {
+        while (!dense.empty()) destroy(handleAt(size() - 1));
+    }
+
+    bool alive(Handle<T> handle) const {
+        return handle.index < generations.size() && generations[handle.index] == handle.generation
+            && densePos[handle.index] < dense.size() && dense[densePos[handle.index]] == handle.index;
+    }
+
+    /**
+     * @brief Current handle of a slot, e.g. from a slot index stored as Box2D user data
+     * @return Null handle if the slot is free
+     */
+    Handle<T> handleOf(uint32_t index) const {
+        Handle<T> handle{ index, index < generations.size() ? generations[index] : 0 };
+        return alive(handle) ? handle : Handle<T>{};
+    }
+
+    /** @brief Object behind a handle, or nullptr if the handle is stale */
+    T* get(Handle<T> handle) { return alive(handle) ? &slots[handle.index] : nullptr; }
+    const T* get(Handle<T> handle) const { return alive(handle) ? &slots[handle.index] : nullptr; }
+
+    /** @brief Number of live objects */
+    int size() const { return (int)dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    /**
+     * @brief Live objects by dense position [0, size())
+     *
+     * destroy() moves the last live object into the freed position, so
+     * iterate backwards when destroying while iterating.
+     */
+    T& at(int i) { return slots[dense[i]]; }
+    const T& at(int i) const { return slots[dense[i]]; }
+    Handle<T> handleAt(int i) const { return Handle<T>{ dense[i], generations[dense[i]] }; }
+
+private:
+    std::vector<T> slots;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> densePos;   // slot -> position in dense
+    std::vector<uint32_t> dense;      // live slot indices
+    std::vector<uint32_t> freeList;
+};
@@ -0,0 +1,259 @@
+#include "Farm.h"
+#include "GameWorld.h"
+#include "Physics.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file Farm.cpp
+ * @brief Implementation of the world farm
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    struct FarmWorld {
+        GameWorld world;
+        long long tick = 0;
+        int owner = -1;                // thread that stepped it last round
+        Clock::duration cost{};        // time of its last round
+    };
+
+    /**
+     * @brief One thread's worlds for the current round
+     *
+     * The owner and thieves claim worlds through the same cursor, so each
+     * world is stepped exactly once per round.
+     */
+    struct Shard {
+        std::vector<int> worlds;
+        std::atomic<int> next{ 0 };
+        Clock::duration load{};
+
+        /**
+         * @brief Claim the next unstarted world
+         * @return World index, or -1 if all are taken
+         */
+        int claim() {
+            int i = next.fetch_add(1);
+            return i < (int)worlds.size() ? worlds[i] : -1;
+        }
+
+        /** @brief Number of worlds nobody has claimed yet */
+        int left() const {
+            return std::max((int)worlds.size() - next.load(), 0);
+        }
+    };
+
+    struct ThreadStats {
+        long long steps = 0;
+        long long migrations = 0;   // worlds stepped here that another thread stepped last round
+        long long stolen = 0;       // worlds taken from another thread's shard
+    };
+
+    /**
+     * @brief Advance one world by one tick, the same tick as the headless mode
+     */
+    void stepWorld(FarmWorld& farmWorld, const HeadlessOptions& options) {
+        GameWorld& world = farmWorld.world;
+        MemoryTag tag(world.memoryTag);
+        if (options.feedInterval > 0 && farmWorld.tick % options.feedInterval == 0) {
+            Command command;
+            command.type = CommandType::SpawnFood;
+            for (int i = 0; i < options.pellets; ++i)
+                world.apply(command);
+            command.type = CommandType::CleanPoop;
+            world.apply(command);
+        }
+        world.updateCats();
+        b2World_Step(world.worldId, PHYSICS_TIME_STEP, PHYSICS_SUB_STEPS);
+        world.eatTouchedFood();
+        farmWorld.tick++;
+    }
+
+}
+
+/**
+ * @brief Run the farm until the tick or time limit
+ *
+ * Worlds are created up front on the calling thread, which then only deals
+ * out the rounds while the pool threads step.
+ */
+int runFarm(const HeadlessOptions& options, int worldCount, int threadCount) {
+    if (options.ticks <= 0 && options.seconds <= 0.0) {
+        fprintf(stderr, "farm: give --ticks=N and/or --seconds=S\n");
+        return 1;
+    }
+    if (worldCount > FARM_MAX_WORLDS) {
+        fprintf(stderr, "farm: Box2D allows at most %d worlds, using %d\n", FARM_MAX_WORLDS, FARM_MAX_WORLDS);
+        worldCount = FARM_MAX_WORLDS;
+    }
+    worldCount = std::max(worldCount, 1);
+    threadCount = std::max(threadCount, 1);
+
+    std::vector<std::unique_ptr<FarmWorld>> worlds;
+    for (int k = 0; k < worldCount; ++k) {
+        worlds.push_back(std::make_unique<FarmWorld>());
+        GameWorld& world = worlds.back()->world;
+        world.create(options.worldWidth, options.worldHeight, options.spawnHeight, nullptr, options.cats);
+        world.seedRandom(options.seed + k);
+    }
+
+    std::vector<Shard> shards(threadCount);
+    std::vector<ThreadStats> threadStats(threadCount);
+
+    std::mutex mu;
+    std::condition_variable cv;
+    long long round = 0;
+    int finished = 0;
+    bool stopping = false;
+
+    auto runRound = [&](int t) {
+        ThreadStats& stats = threadStats[t];
+        for (int s = 0; s < threadCount; ++s) {
+            // Own shard first, then steal from the others while they are well behind
+            int victim = (t + s) % threadCount;
+            Shard& shard = shards[victim];
+            for (;;) {
+                // A shard nobody started yet only has a late owner, leave it be
+                if (victim != t && (shard.next.load() == 0 || shard.left() < FARM_STEAL_MIN_LEFT)) break;
+                int k = shard.claim();
+                if (k < 0) break;
+                FarmWorld& farmWorld = *worlds[k];
+                long long steps = FARM_ROUND_STEPS;
+                if (options.ticks > 0) steps = std::min(steps, options.ticks - farmWorld.tick);
+
+                Clock::time_point start = Clock::now();
+                for (long long i = 0; i < steps; ++i)
+                    stepWorld(farmWorld, options);
+                farmWorld.cost = Clock::now() - start;
+
+                if (farmWorld.owner >= 0 && farmWorld.owner != t) stats.migrations++;
+                if (victim != t) stats.stolen++;
+                farmWorld.owner = t;
+                stats.steps += steps;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            long long seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    cv.wait(lock, [&] { return stopping || round > seen; });
+                    if (stopping) return;
+                    seen = round;
+                }
+                runRound(t);
+                {
+                    std::lock_guard<std::mutex> lock(mu);
+                    finished++;
+                }
+                cv.notify_all();
+            }
+        });
+    }
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    std::vector<int> order(worldCount);
+
+    for (;;) {
+        if (options.seconds > 0.0 && Clock::now() >= deadline) break;
+        if (options.ticks > 0 && worlds[0]->tick >= options.ticks) break;
+
+        // Deal out the worlds, heaviest first. A world stays on its last
+        // thread while that thread is within 10% of an even share, the
+        // rest go to the least loaded thread.
+        Clock::duration total{};
+        for (int k = 0; k < worldCount; ++k) {
+            order[k] = k;
+            total += worlds[k]->cost;
+        }
+        const Clock::duration share = total * 11 / (10 * threadCount);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return worlds[a]->cost > worlds[b]->cost; });
+        for (Shard& shard : shards) {
+            shard.worlds.clear();
+            shard.load = Clock::duration::zero();
+            shard.next = 0;
+        }
+        int moving = 0;
+        for (int k : order) {
+            int owner = worlds[k]->owner;
+            if (owner >= 0 && owner < threadCount && shards[owner].load + worlds[k]->cost <= share) {
+                shards[owner].worlds.push_back(k);
+                shards[owner].load += worlds[k]->cost;
+            }
+            else {
+                order[moving++] = k;
+            }
+        }
+        for (int m = 0; m < moving; ++m) {
+            int k = order[m];
+            Shard* lightest = &shards[0];
+            for (Shard& shard : shards)
+                if (shard.load < lightest->load) lightest = &shard;
+            lightest->worlds.push_back(k);
+            lightest->load += worlds[k]->cost;
+        }
+
+        std::unique_lock<std::mutex> lock(mu);
+        finished = 0;
+        round++;
+        cv.notify_all();
+        cv.wait(lock, [&] { return finished == threadCount; });
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& thread : threads) thread.join();
+
+    long long steps = 0, migrations = 0, stolen = 0, meals = 0, poops = 0;
+    for (const ThreadStats& stats : threadStats) {
+        steps += stats.steps;
+        migrations += stats.migrations;
+        stolen += stats.stolen;
+    }
+    for (const std::unique_ptr<FarmWorld>& farmWorld : worlds) {
+        meals += farmWorld->world.meals;
+        poops += farmWorld->world.poopsMade;
+    }
+
+    printf("farm: %d worlds x %d cats on %d threads: %lld world-steps in %.3f s (%.1f world-steps/sec)\n",
+        worldCount, options.cats, threadCount, steps, elapsed, elapsed > 0.0 ? steps / elapsed : 0.0);
+    long long worldRounds = round * worldCount;
+    printf("  %lld rounds, %lld migrations in %lld world-rounds (%.1f%%, %lld stolen mid-round)\n", round, migrations,
+        worldRounds, worldRounds > 0 ? 100.0 * migrations / worldRounds : 0.0, stolen);
+    printf("  meals eaten: %lld, poops made: %lld\n", meals, poops);
+    for (int t = 0; t < threadCount; ++t)
+        printf("  thread %-3d %5.1f%% of steps\n", t, steps > 0 ? 100.0 * threadStats[t].steps / steps : 0.0);
+
+    long long heaviest = 0;
+    for (const std::unique_ptr<FarmWorld>& farmWorld : worlds)
+        heaviest = std::max(heaviest, memoryStats(farmWorld->world.memoryTag).peakBytes);
+    MemoryStats memory = memoryTotal();
+    printf("  box2d memory: %.1f KB live, %.1f KB peak, %.1f KB per world (heaviest peak %.1f KB)\n",
+        memory.liveBytes / 1024.0, memory.peakBytes / 1024.0,
+        memory.liveBytes / 1024.0 / worldCount, heaviest / 1024.0);
+
+    for (const std::unique_ptr<FarmWorld>& farmWorld : worlds)
+        farmWorld->world.destroy();
+    return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Headless.h"
+
+/**
+ * @file Farm.h
+ * @brief Many independent game worlds stepped by a fixed pool of threads
+ *
+ * Every world has its own Box2D world, cats, food and poop and is stepped
+ * serially, one thread at a time. Worlds advance in rounds of FARM_ROUND_STEPS
+ * steps. Before each round the worlds are dealt out to the threads by their
+ * cost in the last round (heaviest first onto the least loaded thread), so
+ * busy worlds migrate away from overloaded threads. Within a round a thread
+ * that runs out of worlds steals unstarted ones from another thread only if
+ * that thread has begun its share and still has FARM_STEAL_MIN_LEFT or more
+ * of them left, so small imbalances and late wake-ups do not move worlds off
+ * the thread whose cache holds them.
+ */
+
+// Box2D's B2_MAX_WORLDS, the number of worlds one process can have
+constexpr int FARM_MAX_WORLDS = 128;
+
+// Steps each world takes per round between two rebalancings
+constexpr int FARM_ROUND_STEPS = 10;
+
+// Unstarted worlds a thread must have left before an idle thread steals one
+constexpr int FARM_STEAL_MIN_LEFT = 2;
+
+/**
+ * @brief Run a farm of headless worlds and print world-steps/sec
+ * @param options Setup of each world, ticks and seconds limit the whole run
+ * @param worldCount Number of worlds, at most FARM_MAX_WORLDS
+ * @param threadCount Threads stepping the worlds
+ * @return Process exit code
+ */
+int runFarm(const HeadlessOptions& options, int worldCount, int threadCount);
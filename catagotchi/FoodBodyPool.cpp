@@ -0,0 +1,83 @@
+#include "FoodBodyPool.h"
+
+/**
+ * @file FoodBodyPool.cpp
+ * @brief Implementation of the FoodBodyPool
+ */
+
+ /**
+  * @brief Pre-create parked food bodies
+  * @param world Box2D world the bodies live in
+  * @param count Number of bodies to park up front
+  */
+void FoodBodyPool::create(b2WorldId world, int count) {
+    worldId = world;
+    parked.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        b2BodyId bodyId = createBody(0.0f, 0.0f);
+        b2Body_Disable(bodyId);
+        parked.push_back(bodyId);
+    }
+}
+
+/**
+ * @brief Forget parked bodies without touching Box2D (used when the world is destroyed)
+ */
+void FoodBodyPool::clear() {
+    parked.clear();
+}
+
+/**
+ * @brief Create a food body: a small dynamic box
+ */
+b2BodyId FoodBodyPool::createBody(float x, float y) {
+    b2BodyDef fd = b2DefaultBodyDef();
+    fd.type = b2_dynamicBody;
+    fd.position = { x, y };
+    b2BodyId bodyId = b2CreateBody(worldId, &fd);
+
+    b2Polygon fBox = b2MakeBox(0.5f, 0.5f);
+    b2ShapeDef sd = b2DefaultShapeDef();
+    sd.density = 0.8f;
+    sd.enableSensorEvents = true;   // so cat mouths notice it
+    sd.filter.categoryBits = FOOD_CATEGORY;
+    b2ShapeId s = b2CreatePolygonShape(bodyId, &sd, &fBox);
+    b2Shape_SetFriction(s, 0.3f);
+    return bodyId;
+}
+
+/**
+ * @brief Get a food body at a position, falling down
+ * @param x X-position
+ * @param y Y-position
+ *
+ * Reuses a parked body if there is one, otherwise creates a new body.
+ */
+b2BodyId FoodBodyPool::acquire(float x, float y) {
+    b2BodyId bodyId;
+    if (recycle && !parked.empty()) {
+        bodyId = parked.back();
+        parked.pop_back();
+        b2Body_SetTransform(bodyId, { x, y }, b2Rot_identity);
+        b2Body_Enable(bodyId);
+        b2Body_SetAngularVelocity(bodyId, 0.0f);
+    }
+    else {
+        bodyId = createBody(x, y);
+    }
+    b2Body_SetLinearVelocity(bodyId, { 0.0f, 10.0f });
+    return bodyId;
+}
+
+/**
+ * @brief Take a food body out of the simulation
+ * @param bodyId Body returned by acquire()
+ */
+void FoodBodyPool::release(b2BodyId bodyId) {
+    if (!recycle) {
+        b2DestroyBody(bodyId);
+        return;
+    }
+    b2Body_Disable(bodyId);
+    parked.push_back(bodyId);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <box2d/box2d.h>
+#include <vector>
+
+/**
+ * @file FoodBodyPool.h
+ * @brief Recycled Box2D bodies for food pellets
+ *
+ * Creating and destroying a body per pellet churns the broadphase tree, the
+ * id pools and the solver sets. The pool instead parks eaten pellets with
+ * b2Body_Disable and brings them back with a teleport and b2Body_Enable.
+ */
+class FoodBodyPool {
+public:
+    void create(b2WorldId worldId, int count);
+    void clear();
+
+    b2BodyId acquire(float x, float y);
+    void release(b2BodyId bodyId);
+
+    int parkedCount() const { return (int)parked.size(); }
+
+    // Collision category of food shapes, so queries can look for food only
+    static constexpr uint64_t FOOD_CATEGORY = 0x0002;
+
+    // False: no recycling, every acquire creates and every release destroys
+    bool recycle = true;
+
+private:
+    b2WorldId worldId{};
+    std::vector<b2BodyId> parked;
+
+    b2BodyId createBody(float x, float y);
+};
@@ -0,0 +1,164 @@
+#include "FoodTargeting.h"
+#include "FoodBodyPool.h"
+#include <cmath>
+
+/**
+ * @file FoodTargeting.cpp
+ * @brief Implementation of the FoodTargeting
+ */
+
+namespace {
+
+    struct NearestFood {
+        const EntityArena<Food>* foods;
+        float cx;
+        float best;
+        float bestX;
+        FoodHandle handle;
+    };
+
+    /**
+     * @brief b2World_OverlapAABB callback keeping the food closest to the cat
+     */
+    bool visitFood(b2ShapeId shapeId, void* context) {
+        NearestFood* nearest = static_cast<NearestFood*>(context);
+        b2BodyId bodyId = b2Shape_GetBody(shapeId);
+        FoodHandle food = nearest->foods->handleOf((uint32_t)(uintptr_t)b2Body_GetUserData(bodyId));
+        const Food* pellet = nearest->foods->get(food);
+        if (!pellet || !B2_ID_EQUALS(pellet->bodyId, bodyId)) return true;
+
+        float x = b2Body_GetPosition(bodyId).x;
+        float d = fabsf(x - nearest->cx);
+        if (d < nearest->best) {
+            nearest->best = d;
+            nearest->bestX = x;
+            nearest->handle = food;
+        }
+        return true;
+    }
+
+}
+
+/**
+ * @brief Constructs an empty cache
+ * @param capacity Number of cats that fit without reallocating
+ */
+FoodTargeting::FoodTargeting(int capacity) {
+    targetX.reserve(capacity);
+    hasTarget.reserve(capacity);
+    targets.reserve(capacity);
+    foodXAtQuery.reserve(capacity);
+    catXAtQuery.reserve(capacity);
+    valid.reserve(capacity);
+}
+
+/**
+ * @brief Refresh every cat's target, searching only where the cache is stale
+ * @param worldId Box2D world holding the food
+ * @param cats Cats with up to date posX
+ * @param foods Live food
+ * @param worldWidth Width of the Box2D world
+ * @param worldHeight Height of the Box2D world
+ *
+ * The cache is indexed like the CatPool, so it is dropped whenever the
+ * number of cats changes.
+ */
+void FoodTargeting::update(b2WorldId worldId, const CatPool& cats, const EntityArena<Food>& foods,
+    float worldWidth, float worldHeight) {
+    const int n = cats.size();
+    if ((int)targets.size() != n) {
+        targetX.resize(n);
+        hasTarget.resize(n);
+        targets.resize(n);
+        foodXAtQuery.resize(n);
+        catXAtQuery.resize(n);
+        valid.resize(n);
+        invalidateAll();
+    }
+
+    for (int i = 0; i < n; ++i) {
+        float cx = cats.posX[i];
+
+        if (valid[i]) {
+            if (targets[i].isNull()) {
+                // Nothing was found last time and no food dropped since
+                if (foods.empty() || fabsf(cx - catXAtQuery[i]) <= CAT_MOVE_THRESHOLD) {
+                    cacheHits++;
+                    continue;
+                }
+            }
+            else if (const Food* pellet = foods.get(targets[i])) {
+                float fx = b2Body_GetPosition(pellet->bodyId).x;
+                if (fabsf(fx - foodXAtQuery[i]) <= FOOD_MOVE_THRESHOLD &&
+                    fabsf(cx - catXAtQuery[i]) <= CAT_MOVE_THRESHOLD) {
+                    targetX[i] = fx;
+                    cacheHits++;
+                    continue;
+                }
+            }
+        }
+
+        float fx = cx;
+        targets[i] = foods.empty() ? FoodHandle{} : query(worldId, foods, cx, worldWidth, worldHeight, fx);
+        targetX[i] = fx;
+        hasTarget[i] = targets[i].isNull() ? 0 : 1;
+        foodXAtQuery[i] = fx;
+        catXAtQuery[i] = cx;
+        valid[i] = 1;
+    }
+}
+
+/**
+ * @brief Tell the cache about a new pellet
+ * @param cats Cats with posX from the last update
+ * @param x Column the pellet drops at
+ *
+ * Only cats for which the new pellet is closer than their target search again.
+ */
+void FoodTargeting::foodSpawned(const CatPool& cats, float x) {
+    const int n = (int)targets.size() < cats.size() ? (int)targets.size() : cats.size();
+    for (int i = 0; i < n; ++i) {
+        float cx = cats.posX[i];
+        bool closer = targets[i].isNull() || fabsf(x - cx) < fabsf(targetX[i] - cx);
+        valid[i] = closer ? 0 : valid[i];
+    }
+}
+
+/**
+ * @brief Make every cat search again on the next update
+ */
+void FoodTargeting::invalidateAll() {
+    for (size_t i = 0; i < valid.size(); ++i)
+        valid[i] = 0;
+}
+
+/**
+ * @brief Search the broadphase for the food nearest to a cat
+ * @param worldId Box2D world holding the food
+ * @param foods Live food
+ * @param cx X-position of the cat
+ * @param worldWidth Width of the Box2D world
+ * @param worldHeight Height of the Box2D world
+ * @param foodX Set to the x-position of the food found
+ * @return Nearest food, or a null handle if there is none
+ */
+FoodHandle FoodTargeting::query(b2WorldId worldId, const EntityArena<Food>& foods, float cx,
+    float worldWidth, float worldHeight, float& foodX) {
+    b2QueryFilter filter = b2DefaultQueryFilter();
+    filter.maskBits = FoodBodyPool::FOOD_CATEGORY;
+
+    queries++;
+    NearestFood nearest{ &foods, cx, 3.4e38f, cx, FoodHandle{} };
+    float half = START_HALF_WIDTH;
+    for (;;) {
+        b2AABB box = { { cx - half, -worldHeight }, { cx + half, 2.0f * worldHeight } };
+        b2World_OverlapAABB(worldId, box, filter, visitFood, &nearest);
+
+        // Food in the box is nearer than all food whose shape is outside of it.
+        // A hit whose shape only pokes into the box needs one more look.
+        if (nearest.handle.isNull() ? half >= worldWidth : nearest.best <= half) break;
+        half = nearest.handle.isNull() ? half * 2.0f : nearest.best;
+    }
+    foodX = nearest.bestX;
+    return nearest.handle;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <box2d/box2d.h>
+#include <cstdint>
+#include <vector>
+#include "Catagotchi.h"
+#include "CatPool.h"
+#include "EntityArena.h"
+
+/**
+ * @file FoodTargeting.h
+ * @brief Finds the nearest food for every cat through the Box2D broadphase
+ *
+ * Instead of scanning every pellet for every cat, each cat asks the world
+ * for food shapes in a box around it with b2World_OverlapAABB, doubling the
+ * box until something is found. The box spans the whole world height, so the
+ * first hit set always contains the pellet nearest along the ground.
+ *
+ * Results are cached per cat and only searched again when
+ * - the targeted pellet was eaten (its handle went stale),
+ * - a new pellet dropped closer than the current target,
+ * - the target rolled or the cat walked further than a small threshold.
+ */
+class FoodTargeting {
+public:
+    // Search box half width to start with, doubled until food is found
+    static constexpr float START_HALF_WIDTH = 8.0f;
+    // Re-search once the target or the cat moved this far sideways
+    static constexpr float FOOD_MOVE_THRESHOLD = 1.0f;
+    static constexpr float CAT_MOVE_THRESHOLD = 4.0f;
+
+    explicit FoodTargeting(int capacity = 1024);
+
+    void update(b2WorldId worldId, const CatPool& cats, const EntityArena<Food>& foods,
+        float worldWidth, float worldHeight);
+    void foodSpawned(const CatPool& cats, float x);
+    void invalidateAll();
+
+    // One entry per cat after update(), indexed like CatPool
+    std::vector<float> targetX;
+    std::vector<uint8_t> hasTarget;
+
+    // Totals since construction
+    long long queries = 0;
+    long long cacheHits = 0;
+
+private:
+    std::vector<FoodHandle> targets;
+    std::vector<float> foodXAtQuery;
+    std::vector<float> catXAtQuery;
+    std::vector<uint8_t> valid;
+
+    FoodHandle query(b2WorldId worldId, const EntityArena<Food>& foods, float cx,
+        float worldWidth, float worldHeight, float& foodX);
+};
@@ -0,0 +1,65 @@
+#include "FrameArena.h"
+#include <cstdint>
+
+/**
+ * @file FrameArena.cpp
+ * @brief Implementation of the FrameArena
+ */
+
+ /**
+  * @brief Constructs an arena
+  * @param capacity Bytes to start with, the arena grows to what frames need
+  */
+FrameArena::FrameArena(size_t capacity)
+    : block(new char[capacity]), size(capacity) {
+    overflow.reserve(16);
+}
+
+/**
+ * @brief Frees the arena, everything handed out becomes invalid
+ */
+FrameArena::~FrameArena() {
+    reset();
+    delete[] block;
+}
+
+/**
+ * @brief Bytes that stay valid until reset()
+ * @param bytes Size of the buffer
+ * @param alignment Power of two
+ */
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block);
+    uintptr_t start = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (start + bytes <= base + size) {
+        offset = start + bytes - base;
+        return reinterpret_cast<void*>(start);
+    }
+
+    // Full: borrow from the heap for this frame, reset() makes room for next time
+    char* extra = new char[bytes + alignment];
+    overflow.push_back(extra);
+    overflowBytes += bytes + alignment;
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(extra) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return reinterpret_cast<void*>(aligned);
+}
+
+/**
+ * @brief Take back everything handed out since the last reset()
+ *
+ * If the frame overflowed, the arena is replaced by one big enough for it.
+ */
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        size_t needed = offset + overflowBytes;
+        for (char* extra : overflow) delete[] extra;
+        overflow.clear();
+        overflowBytes = 0;
+
+        delete[] block;
+        size = needed + needed / 2;
+        block = new char[size];
+        growCount++;
+    }
+    offset = 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file FrameArena.h
+ * @brief Bump allocator for buffers that only live for one frame or step
+ *
+ * alloc() hands out memory by moving a pointer forward, reset() at the end
+ * of the frame takes all of it back at once. Nothing is ever freed one by
+ * one and no destructors run, so only trivially destructible types belong
+ * here (floats, ints, chars).
+ *
+ * When a frame needs more than the arena holds, the rest is served from
+ * extra heap blocks and reset() grows the arena to the frame's high-water
+ * mark, so after the first few frames no frame touches the heap.
+ */
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    void reset();
+
+    /**
+     * @brief Uninitialized room for count values of T until reset()
+     */
+    template <typename T>
+    T* alloc(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    size_t capacity() const { return size; }
+    size_t used() const { return offset + overflowBytes; }
+    long long grows() const { return growCount; }
+
+private:
+    char* block = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+
+    // Heap blocks for what did not fit, freed by reset()
+    std::vector<char*> overflow;
+    size_t overflowBytes = 0;
+    long long growCount = 0;
+};
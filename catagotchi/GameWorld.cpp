@@ -0,0 +1,471 @@
+#include "GameWorld.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file GameWorld.cpp
+ * @brief Implementation of the GameWorld
+ */
+
+namespace {
+
+    /**
+     * @brief Copy a body's state for a save file
+     */
+    SavedBody saveBody(b2BodyId bodyId) {
+        b2Transform xf = b2Body_GetTransform(bodyId);
+        b2Vec2 v = b2Body_GetLinearVelocity(bodyId);
+        SavedBody body{};
+        body.x = xf.p.x;
+        body.y = xf.p.y;
+        body.cosAngle = xf.q.c;
+        body.sinAngle = xf.q.s;
+        body.vx = v.x;
+        body.vy = v.y;
+        body.angularVelocity = b2Body_GetAngularVelocity(bodyId);
+        body.awake = b2Body_IsAwake(bodyId) ? 1 : 0;
+        return body;
+    }
+
+    /**
+     * @brief Body definition that creates a body directly in a saved state
+     */
+    b2BodyDef savedBodyDef(const SavedBody& body) {
+        b2BodyDef bd = b2DefaultBodyDef();
+        bd.position = { body.x, body.y };
+        bd.rotation = { body.cosAngle, body.sinAngle };
+        bd.linearVelocity = { body.vx, body.vy };
+        bd.angularVelocity = body.angularVelocity;
+        bd.isAwake = body.awake != 0;
+        return bd;
+    }
+
+    /**
+     * @brief Put an existing body back into a saved state
+     */
+    void loadBody(b2BodyId bodyId, const SavedBody& body) {
+        b2Body_SetTransform(bodyId, { body.x, body.y }, { body.cosAngle, body.sinAngle });
+        b2Body_SetLinearVelocity(bodyId, { body.vx, body.vy });
+        b2Body_SetAngularVelocity(bodyId, body.angularVelocity);
+        if (!body.awake) b2Body_SetAwake(bodyId, false);
+    }
+
+}
+
+ /**
+  * @brief Create the Box2D world, the ground and the cats
+  * @param worldWidth Width of the world (in terminal columns)
+  * @param worldHeight Height of the world (in terminal rows)
+  * @param foodSpawnHeight Row where new food drops from
+  * @param scheduler Thread pool for Box2D's parallel stages, nullptr steps serially
+  * @param catCount Number of cats, spread evenly over the ground
+  * @param foodBodyCount Food bodies to pre-create and park for recycling
+  */
+void GameWorld::create(float worldWidth, float worldHeight, int foodSpawnHeight,
+    TaskScheduler* scheduler, int catCount, int foodBodyCount) {
+    width = worldWidth;
+    height = worldHeight;
+    spawnHeight = foodSpawnHeight;
+    memoryTag = memoryNewTag();
+    MemoryTag tag(memoryTag);
+
+    b2WorldDef wdef = b2DefaultWorldDef();
+    wdef.gravity = { 0.0f, 10.0f };
+    if (scheduler) scheduler->configure(wdef);
+    worldId = b2CreateWorld(&wdef);
+
+    // Ground initialization
+    geometry.create(worldId);
+    geometry.addBox(width * 0.5f, height - 1.0f, width * 0.5f, 1.0f, 0.8f);
+    geometry.commit();
+
+    // Cat spawnage
+    for (int i = 0; i < catCount; ++i)
+        cats.spawn(worldId, width * (i + 1) / (catCount + 1), height - 2.0f);
+
+    foodBodies.create(worldId, foodBodyCount);
+}
+
+/**
+ * @brief Destroy the Box2D world and drop all game objects
+ */
+void GameWorld::destroy() {
+    MemoryTag tag(memoryTag);
+    cats.clear();
+    foods.clear();
+    foodBodies.clear();
+    targeting.invalidateAll();
+    poops.clear();
+    geometry.clear();
+    b2DestroyWorld(worldId);
+    worldId = b2_nullWorldId;
+}
+
+/**
+ * @brief Copy the whole game state into a save
+ * @param out Save to fill, its arrays keep their capacity between saves
+ *
+ * Only reads the world, so the physics thread can call it between two steps
+ * and leave the writing to a WorldSaver.
+ */
+void GameWorld::capture(WorldSave& out) const {
+    TraceScope trace("save capture");
+    out.header = WorldSaveHeader{};
+    out.header.seed = seed;
+    out.header.rngState = rngState;
+    out.header.worldWidth = width;
+    out.header.worldHeight = height;
+    out.header.spawnHeight = spawnHeight;
+    out.header.meals = meals;
+    out.header.poopsMade = poopsMade;
+    out.header.poopsCleaned = poopsCleaned;
+
+    out.cats.resize(cats.size());
+    for (int i = 0; i < cats.size(); ++i) {
+        SavedCat& cat = out.cats[i];
+        cat = SavedCat{};
+        cat.body = saveBody(cats.bodyIds[i]);
+        cat.eaten = cats.eaten[i];
+        cat.state = (uint8_t)cats.states[i];
+    }
+    out.foods.resize(foods.size());
+    for (int f = 0; f < foods.size(); ++f)
+        out.foods[f].body = saveBody(foods.at(f).bodyId);
+    out.poops.resize(poops.size());
+    for (int p = 0; p < poops.size(); ++p)
+        out.poops[p] = SavedPoop{ poops.at(p).x, poops.at(p).y };
+}
+
+/**
+ * @brief Create the world from a mapped save instead of from scratch
+ * @param save Save opened with MappedWorldSave::open
+ * @param scheduler Thread pool for Box2D's parallel stages, nullptr steps serially
+ *
+ * Bodies are created straight from the mapped records.
+ */
+void GameWorld::restore(const MappedWorldSave& save, TaskScheduler* scheduler) {
+    const WorldSaveHeader& header = save.header();
+    create(header.worldWidth, header.worldHeight, header.spawnHeight, scheduler, 0);
+    MemoryTag tag(memoryTag);
+    seed = header.seed;
+    rngState = header.rngState;
+    meals = header.meals;
+    poopsMade = header.poopsMade;
+    poopsCleaned = header.poopsCleaned;
+
+    const SavedCat* savedCats = save.cats();
+    for (int i = 0; i < header.catCount; ++i) {
+        const SavedCat& cat = savedCats[i];
+        cats.spawn(worldId, savedBodyDef(cat.body));
+        cats.eaten[i] = cat.eaten;
+        cats.states[i] = (CatState)cat.state;
+    }
+
+    const SavedFood* savedFoods = save.foods();
+    for (int f = 0; f < header.foodCount; ++f) {
+        FoodHandle food = foods.create();
+        Food* pellet = foods.get(food);
+        pellet->create(foodBodies, savedFoods[f].body.x, savedFoods[f].body.y);
+        b2Body_SetUserData(pellet->bodyId, (void*)(uintptr_t)food.index);
+        loadBody(pellet->bodyId, savedFoods[f].body);
+    }
+
+    const SavedPoop* savedPoops = save.poops();
+    for (int p = 0; p < header.poopCount; ++p) {
+        PoopHandle poop = poops.create();
+        Poop* pile = poops.get(poop);
+        pile->create(geometry, { savedPoops[p].x, savedPoops[p].y });
+        b2Shape_SetUserData(pile->shapeId, (void*)(uintptr_t)poop.index);
+    }
+    geometry.commit();
+}
+
+/**
+ * @brief Restart the food RNG
+ * @param newSeed Any value, the same seed gives the same food drops
+ */
+void GameWorld::seedRandom(uint32_t newSeed) {
+    seed = newSeed;
+    rngState = newSeed ? newSeed : 0x9e3779b9u;
+}
+
+/**
+ * @brief Next value of the food RNG (xorshift32)
+ * @return Pseudo-random 32-bit value
+ */
+uint32_t GameWorld::nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/**
+ * @brief Hash of every body transform and the game counters
+ * @return Value that differs as soon as two runs diverge
+ *
+ * Same approach as the falling hinges determinism test in Box2D's shared code.
+ */
+uint32_t GameWorld::hash() const {
+    uint32_t h = B2_HASH_INIT;
+    for (int i = 0; i < cats.size(); ++i) {
+        b2Transform xf = b2Body_GetTransform(cats.bodyIds[i]);
+        h = b2Hash(h, (const uint8_t*)&xf, sizeof(xf));
+    }
+    for (int f = 0; f < foods.size(); ++f) {
+        b2Transform xf = b2Body_GetTransform(foods.at(f).bodyId);
+        h = b2Hash(h, (const uint8_t*)&xf, sizeof(xf));
+    }
+    for (int p = 0; p < poops.size(); ++p) {
+        float x = poops.at(p).x;
+        h = b2Hash(h, (const uint8_t*)&x, sizeof(x));
+    }
+    long long counters[3] = { meals, poopsMade, poopsCleaned };
+    return b2Hash(h, (const uint8_t*)counters, sizeof(counters));
+}
+
+/**
+ * @brief Everything needed to build this world again for a replay
+ * @return Header for SessionRecorder::open
+ */
+SessionHeader GameWorld::sessionHeader() const {
+    SessionHeader header;
+    header.seed = seed;
+    header.worldWidth = width;
+    header.worldHeight = height;
+    header.spawnHeight = spawnHeight;
+    header.cats = cats.size();
+    return header;
+}
+
+/**
+ * @brief Apply every command queued since the last step
+ * @param commands Queue filled by input handling or the headless feeder
+ * @param recorder Session being recorded, or nullptr
+ *
+ * Called by the thread that owns the world at the start of each step.
+ * How long each command waited is kept in commandLatency.
+ */
+void GameWorld::applyCommands(CommandQueue& commands, SessionRecorder* recorder) {
+    TraceScope trace("commands");
+    Command command;
+    while (commands.pop(command)) {
+        apply(command);
+        commandLatency.record(command, CommandQueue::now());
+        if (recorder) recorder->command(command);
+    }
+}
+
+/**
+ * @brief Apply a single command to the world
+ * @param command Command to apply
+ *
+ * There is at most one pellet per cat in the world, extra feeding is ignored.
+ */
+void GameWorld::apply(const Command& command) {
+    switch (command.type) {
+    case CommandType::SpawnFood:
+        if (foods.size() < cats.size()) spawnFood();
+        break;
+    case CommandType::CleanPoop:
+        cleanPoop();
+        break;
+    }
+}
+
+/**
+ * @brief Run the cat AI: walk toward the nearest food, avoiding poop
+ *
+ * Called before the step. Eating happens after it in eatTouchedFood().
+ */
+void GameWorld::updateCats() {
+    TraceScope trace("cat AI");
+    cats.gatherPositions();
+    targeting.update(worldId, cats, foods, width, height);
+
+    float* poopX = scratch.alloc<float>(poops.size());
+    for (int p = 0; p < poops.size(); ++p)
+        poopX[p] = poops.at(p).x;
+    std::sort(poopX, poopX + poops.size());
+
+    cats.moveToward(targeting.targetX.data(), targeting.hasTarget.data(), poopX, poops.size(), width);
+    scratch.reset();
+}
+
+/**
+ * @brief Let cats eat the food that started touching their mouth sensor
+ *
+ * Called once after each step. Cost scales with the number of new
+ * mouth/food overlaps, not with cats times food.
+ */
+void GameWorld::eatTouchedFood() {
+    TraceScope trace("eat");
+    b2SensorEvents events = b2World_GetSensorEvents(worldId);
+    for (int e = 0; e < events.beginCount; ++e) {
+        const b2SensorBeginTouchEvent& touch = events.beginEvents[e];
+        if (!b2Shape_IsValid(touch.sensorShapeId) || !b2Shape_IsValid(touch.visitorShapeId)) continue;
+
+        // The same pellet may touch several mouths, only the first cat gets it
+        b2BodyId foodBody = b2Shape_GetBody(touch.visitorShapeId);
+        FoodHandle food = foods.handleOf((uint32_t)(uintptr_t)b2Body_GetUserData(foodBody));
+        Food* pellet = foods.get(food);
+        if (!pellet || !B2_ID_EQUALS(pellet->bodyId, foodBody)) continue;
+
+        int i = cats.indexOfBody(b2Shape_GetBody(touch.sensorShapeId));
+        if (i < 0) continue;
+
+        pellet->destroy(foodBodies);
+        foods.destroy(food);
+        meals++;
+
+        // One poop per cat at most, like the food
+        if (cats.eat(i) && poops.size() < cats.size()) {
+            b2Vec2 cpos = b2Body_GetPosition(cats.bodyIds[i]);
+            cats.posX[i] = cpos.x;
+            cats.posY[i] = cpos.y;
+
+            PoopHandle poop = poops.create();
+            Poop* pile = poops.get(poop);
+            pile->create(geometry, cpos);
+            b2Shape_SetUserData(pile->shapeId, (void*)(uintptr_t)poop.index);
+            poopsMade++;
+            cats.resetMeals(i);
+            cats.scootAway(i, width);
+        }
+    }
+    // All of this step's new poop goes into the static tree at once
+    geometry.commit();
+}
+
+namespace {
+
+    struct VisibleQuery {
+        const GameWorld* world;
+        RenderSnapshot* out;
+    };
+
+    /**
+     * @brief b2OverlapResultFcn: add a cat, pellet or poop in view to the snapshot
+     */
+    bool addVisible(b2ShapeId shapeId, void* context) {
+        VisibleQuery& query = *static_cast<VisibleQuery*>(context);
+        const GameWorld& world = *query.world;
+        uint64_t category = b2Shape_GetFilter(shapeId).categoryBits;
+
+        if (category == StaticGeometry::POOP_CATEGORY) {
+            PoopHandle poop = world.poops.handleOf((uint32_t)(uintptr_t)b2Shape_GetUserData(shapeId));
+            const Poop* pile = world.poops.get(poop);
+            if (pile && B2_ID_EQUALS(pile->shapeId, shapeId)) query.out->poops.push_back(pile->view());
+            return true;
+        }
+        b2BodyId bodyId = b2Shape_GetBody(shapeId);
+        if (category == CatPool::CAT_CATEGORY) {
+            int i = world.cats.indexOfBody(bodyId);
+            if (i >= 0) query.out->cats.push_back(world.cats.view(i));
+            return true;
+        }
+        FoodHandle food = world.foods.handleOf((uint32_t)(uintptr_t)b2Body_GetUserData(bodyId));
+        const Food* pellet = world.foods.get(food);
+        if (pellet && B2_ID_EQUALS(pellet->bodyId, bodyId)) query.out->foods.push_back(pellet->view());
+        return true;
+    }
+
+}
+
+/**
+ * @brief Copy what the camera sees into a snapshot frame
+ * @param out Frame to fill
+ * @param stepIndex Number of physics steps taken so far
+ * @param view Terminal size and the cat to follow
+ *
+ * The camera centers on the selected cat and stops at the world's edges.
+ * Cats, food and poop are found with one b2World_OverlapAABB over the
+ * visible area, so the cost follows what is on screen and not the colony size.
+ */
+void GameWorld::snapshot(RenderSnapshot& out, long long stepIndex, const Viewport& view) const {
+    TraceScope trace("snapshot");
+    out.stepIndex = stepIndex;
+    out.worldWidth = width;
+    out.worldHeight = height;
+    out.poopCount = poops.size();
+    out.cats.clear();
+    out.foods.clear();
+    out.poops.clear();
+
+    // Terminal size unknown yet: everything, drawn from the world's origin
+    if (view.cols <= 0 || view.rows <= 0) {
+        out.cameraX = 0.0f;
+        out.cameraY = 0.0f;
+        for (int i = 0; i < cats.size(); ++i)
+            out.cats.push_back(cats.view(i));
+        for (int f = 0; f < foods.size(); ++f)
+            out.foods.push_back(foods.at(f).view());
+        for (int p = 0; p < poops.size(); ++p)
+            out.poops.push_back(poops.at(p).view());
+        return;
+    }
+
+    // Follow the selected cat, or center the world if it fits the terminal
+    b2Vec2 focus = { width * 0.5f, height * 0.5f };
+    if (cats.size() > 0) {
+        int selected = view.selectedCat % cats.size();
+        if (selected < 0) selected += cats.size();
+        focus = b2Body_GetPosition(cats.bodyIds[selected]);
+    }
+    auto follow = [](float focus, float size, float visible) {
+        if (size <= visible) return -floorf((visible - size) * 0.5f);
+        return floorf(b2ClampFloat(focus - visible * 0.5f, 0.0f, size - visible));
+    };
+    out.cameraX = follow(focus.x, width, (float)view.cols);
+    // Keep the ground at the bottom of the screen when the world is short
+    out.cameraY = height <= view.rows ? height - view.rows : follow(focus.y, height, (float)view.rows);
+
+    // Sprites start at the body's x, so look one sprite width further left
+    const float margin = 6.0f;
+    b2AABB visible;
+    visible.lowerBound = { out.cameraX - margin, out.cameraY - 1.0f };
+    visible.upperBound = { out.cameraX + view.cols + 1.0f, out.cameraY + view.rows + 1.0f };
+
+    // Poop piles only accept their own category, so the query claims it
+    b2QueryFilter filter = b2DefaultQueryFilter();
+    filter.categoryBits = StaticGeometry::POOP_CATEGORY;
+    filter.maskBits = CatPool::CAT_CATEGORY | FoodBodyPool::FOOD_CATEGORY | StaticGeometry::POOP_CATEGORY;
+    VisibleQuery query{ this, &out };
+    b2World_OverlapAABB(worldId, visible, filter, &addVisible, &query);
+}
+
+/**
+ * @brief Drop a new food at a random column
+ */
+void GameWorld::spawnFood() {
+    float fx = static_cast<float>(4 + nextRandom() % (uint32_t)((int)width - 8));
+
+    // Don't let food 2 drop on poop!
+    for (int p = 0; p < poops.size(); ++p) {
+        float px = poops.at(p).x;
+        if (fx >= px - 1 && fx <= px + 1) {
+            fx = px + 2.0f;
+            break;
+        }
+    }
+
+    FoodHandle food = foods.create();
+    Food* pellet = foods.get(food);
+    pellet->create(foodBodies, fx, static_cast<float>(spawnHeight + 1));
+    b2Body_SetUserData(pellet->bodyId, (void*)(uintptr_t)food.index);
+    targeting.foodSpawned(cats, fx);
+}
+
+/**
+ * @brief Remove all poop from the Box2D world
+ */
+void GameWorld::cleanPoop() {
+    for (int p = poops.size() - 1; p >= 0; --p) {
+        poops.at(p).destroy(geometry);
+        poops.destroy(poops.handleAt(p));
+        poopsCleaned++;
+    }
+    geometry.commit();
+}
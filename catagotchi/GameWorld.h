@@ -0,0 +1,76 @@
+#pragma once
+#include <box2d/box2d.h>
+#include <vector>
+#include "Catagotchi.h"
+#include "CatPool.h"
+#include "FoodTargeting.h"
+#include "RenderSnapshot.h"
+#include "CommandQueue.h"
+#include "SessionLog.h"
+#include "WorldSave.h"
+#include "TaskScheduler.h"
+#include "FrameArena.h"
+
+/**
+ * @file GameWorld.h
+ * @brief The Box2D world together with the cat, food and poop living in it
+ *
+ * Shared by the curses game and the headless simulation so that both run
+ * exactly the same game logic.
+ */
+
+// Smallest world create() handles: food drops at least 4 columns in from
+// either edge, and below the food's spawn row there must be room for the
+// drop, the cats and the ground
+constexpr int GAME_WORLD_MIN_WIDTH = 16;
+constexpr int GAME_WORLD_MIN_ROWS_BELOW_SPAWN = 4;
+
+struct GameWorld {
+    b2WorldId worldId{};
+    float width = 0.0f;
+    float height = 0.0f;
+    int spawnHeight = 0;
+
+    CatPool cats;
+    EntityArena<Food> foods{ 1024 };
+    FoodBodyPool foodBodies;
+    EntityArena<Poop> poops{ 1024 };
+    StaticGeometry geometry;
+    FoodTargeting targeting;
+
+    // Totals since create()
+    long long meals = 0;
+    long long poopsMade = 0;
+    long long poopsCleaned = 0;
+    CommandLatencyLog commandLatency;
+
+    // Food RNG, seeded so that recorded sessions replay exactly
+    uint32_t seed = 1;
+    uint32_t rngState = 1;
+
+    // Box2D memory of this world is counted under this tag, see MemoryTracker.h
+    int memoryTag = 0;
+
+    void create(float worldWidth, float worldHeight, int foodSpawnHeight,
+        TaskScheduler* scheduler = nullptr, int catCount = 1, int foodBodyCount = 64);
+    void destroy();
+    void capture(WorldSave& out) const;
+    void restore(const MappedWorldSave& save, TaskScheduler* scheduler = nullptr);
+
+    void seedRandom(uint32_t newSeed);
+    uint32_t nextRandom();
+    uint32_t hash() const;
+    SessionHeader sessionHeader() const;
+
+    void applyCommands(CommandQueue& commands, SessionRecorder* recorder = nullptr);
+    void apply(const Command& command);
+    void updateCats();
+    void eatTouchedFood();
+    void snapshot(RenderSnapshot& out, long long stepIndex, const Viewport& view) const;
+    void spawnFood();
+    void cleanPoop();
+
+private:
+    // Temporary buffers of one step, reset when the step's AI is done
+    FrameArena scratch{ 16 * 1024 };
+};
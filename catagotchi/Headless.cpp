@@ -0,0 +1,392 @@
+#include "Headless.h"
+#include "GameWorld.h"
+#include "Physics.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include "HeapCounter.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/**
+ * @file Headless.cpp
+ * @brief Implementation of the headless simulation
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    /**
+     * @brief Accumulated wall time of one phase of the tick
+     */
+    struct PhaseTimer {
+        const char* name;
+        Clock::duration total{};
+
+        void print(long long ticks) const {
+            double ms = std::chrono::duration<double, std::milli>(total).count();
+            double usPerTick = ticks > 0 ? ms * 1000.0 / ticks : 0.0;
+            printf("  %-6s %10.2f ms  %8.3f us/tick\n", name, ms, usPerTick);
+        }
+    };
+
+}
+
+/**
+ * @brief Run the game without a terminal
+ *
+ * Each tick the automatic feeder plays the role of the user (feeds, cleans
+ * poop), then the cat AI runs, the world is stepped and cats eat.
+ */
+int runHeadless(const HeadlessOptions& options) {
+    if (options.ticks <= 0 && options.seconds <= 0.0) {
+        fprintf(stderr, "headless: give --ticks=N and/or --seconds=S\n");
+        return 1;
+    }
+
+    traceThread("headless");
+    if (options.trace) traceEnable(true);
+
+    TaskScheduler scheduler(options.workers);
+    GameWorld world;
+    MappedWorldSave saved;
+    bool restored = options.save && saved.open(options.save);
+    if (restored) {
+        Clock::time_point loadStart = Clock::now();
+        world.restore(saved, &scheduler);
+        saved.close();
+        printf("headless: restored %d cats, %d food, %d poop from %s in %.2f ms\n",
+            world.cats.size(), world.foods.size(), world.poops.size(), options.save,
+            std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count());
+    }
+    else {
+        world.create(options.worldWidth, options.worldHeight, options.spawnHeight, &scheduler, options.cats);
+        world.seedRandom(options.seed);
+    }
+    CommandQueue commands;
+
+    SessionRecorder recorder;
+    if (options.record && restored) {
+        fprintf(stderr, "headless: --record needs a new world, not one restored from %s\n", options.save);
+        world.destroy();
+        return 1;
+    }
+    if (options.record && !recorder.open(options.record, world.sessionHeader())) {
+        fprintf(stderr, "headless: cannot write %s\n", options.record);
+        world.destroy();
+        return 1;
+    }
+    SessionRecorder* recording = recorder.isOpen() ? &recorder : nullptr;
+
+    PhaseTimer feedPhase{ "feed" };
+    PhaseTimer aiPhase{ "ai" };
+    PhaseTimer stepPhase{ "step" };
+    PhaseTimer eatPhase{ "eat" };
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+
+    MemoryTag memoryTag(world.memoryTag);
+    const MemoryStats memoryStart = memoryStats(world.memoryTag);
+    long long heapTotal = 0, allocatingTicks = 0, lastAllocatingTick = 0;
+    long long tick = 0;
+    while (options.ticks <= 0 || tick < options.ticks) {
+        long long heapAtStart = threadHeapAllocations();
+        Clock::time_point t0 = Clock::now();
+        if (options.seconds > 0.0 && t0 >= deadline) break;
+
+        // Automatic feeder instead of keypresses. A full queue is applied
+        // right away, in order, so no pellet is dropped however many there are.
+        if (options.feedInterval > 0 && tick % options.feedInterval == 0) {
+            auto feed = [&](CommandType type) {
+                while (!commands.push(type)) world.applyCommands(commands, recording);
+            };
+            for (int i = 0; i < options.pellets; ++i)
+                feed(CommandType::SpawnFood);
+            feed(CommandType::CleanPoop);
+        }
+        world.applyCommands(commands, recording);
+        Clock::time_point t1 = Clock::now();
+
+        world.updateCats();
+        Clock::time_point t2 = Clock::now();
+
+        int64_t traceStart = traceEnabled() ? traceNow() : 0;
+        b2World_Step(world.worldId, PHYSICS_TIME_STEP, PHYSICS_SUB_STEPS);
+        Clock::time_point t3 = Clock::now();
+        if (traceEnabled()) traceWorldStep(world.worldId, traceStart, traceNow());
+
+        world.eatTouchedFood();
+        if (recording) recording->endStep(world.hash());
+        Clock::time_point t4 = Clock::now();
+
+        feedPhase.total += t1 - t0;
+        aiPhase.total += t2 - t1;
+        stepPhase.total += t3 - t2;
+        eatPhase.total += t4 - t3;
+        tick++;
+
+        long long allocations = threadHeapAllocations() - heapAtStart;
+        if (allocations > 0) {
+            heapTotal += allocations;
+            allocatingTicks++;
+            lastAllocatingTick = tick;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("headless: %lld ticks in %.3f s with %d cats, %d workers (%.1f ticks/sec, %.1fx real time)\n",
+        tick, elapsed, world.cats.size(), scheduler.workerCount(), elapsed > 0.0 ? tick / elapsed : 0.0,
+        elapsed > 0.0 ? tick * PHYSICS_TIME_STEP / elapsed : 0.0);
+    printf("  meals eaten: %lld, poops made: %lld, poops cleaned: %lld\n",
+        world.meals, world.poopsMade, world.poopsCleaned);
+    long long lookups = world.targeting.queries + world.targeting.cacheHits;
+    printf("  food targeting: %lld searches, %lld cached (%.1f%% hit rate)\n",
+        world.targeting.queries, world.targeting.cacheHits,
+        lookups > 0 ? 100.0 * world.targeting.cacheHits / lookups : 0.0);
+    feedPhase.print(tick);
+    aiPhase.print(tick);
+    stepPhase.print(tick);
+    eatPhase.print(tick);
+
+    MemoryStats memory = memoryStats(world.memoryTag);
+    long long allocations = memory.allocations - memoryStart.allocations;
+    printf("  box2d memory: %.1f KB live, %.1f KB peak (%lld bytes per cat), %lld allocations while running (%.1f/sec)\n",
+        memory.liveBytes / 1024.0, memory.peakBytes / 1024.0,
+        world.cats.size() > 0 ? memory.liveBytes / world.cats.size() : 0LL,
+        allocations, elapsed > 0.0 ? allocations / elapsed : 0.0);
+    printf("  heap: %lld allocations in %lld of %lld ticks, the last in tick %lld\n",
+        heapTotal, allocatingTicks, tick, lastAllocatingTick);
+
+    if (options.save) {
+        Clock::time_point saveStart = Clock::now();
+        WorldSave save;
+        world.capture(save);
+        Clock::time_point captured = Clock::now();
+        bool ok = writeWorldSave(save, options.save);
+        Clock::time_point written = Clock::now();
+        if (!ok) fprintf(stderr, "headless: cannot write %s\n", options.save);
+        else printf("  saved to %s: capture %.2f ms, write %.2f ms\n", options.save,
+            std::chrono::duration<double, std::milli>(captured - saveStart).count(),
+            std::chrono::duration<double, std::milli>(written - captured).count());
+    }
+
+    if (options.trace) {
+        traceEnable(false);
+        if (traceWrite(options.trace)) printf("  trace written to %s\n", options.trace);
+        else fprintf(stderr, "headless: cannot write %s\n", options.trace);
+    }
+
+    world.destroy();
+    return 0;
+}
+
+namespace {
+
+    struct FoodRainResult {
+        long long spawns = 0;
+        Clock::duration churn{};   // acquire + release
+        Clock::duration step{};
+    };
+
+    /**
+     * @brief One run of the food rain with or without body recycling
+     */
+    FoodRainResult runFoodRain(bool recycle, int spawnsPerSecond, int steps) {
+        const float width = 400.0f;
+        const float height = 60.0f;
+        const int maxLive = 4000;
+
+        b2WorldDef wdef = b2DefaultWorldDef();
+        wdef.gravity = { 0.0f, 10.0f };
+        b2WorldId worldId = b2CreateWorld(&wdef);
+
+        b2BodyDef gbd = b2DefaultBodyDef();
+        gbd.position = { width * 0.5f, height - 1.0f };
+        b2BodyId groundId = b2CreateBody(worldId, &gbd);
+        b2Polygon groundBox = b2MakeBox(width * 0.5f, 1.0f);
+        b2ShapeDef gsd = b2DefaultShapeDef();
+        b2CreatePolygonShape(groundId, &gsd, &groundBox);
+
+        FoodBodyPool pool;
+        pool.recycle = recycle;
+        pool.create(worldId, recycle ? maxLive : 0);
+
+        // Oldest pellet first
+        std::vector<b2BodyId> live(maxLive);
+        int head = 0, count = 0;
+
+        FoodRainResult result;
+        uint32_t seed = 12345;
+        float due = 0.0f;
+        for (int i = 0; i < steps; ++i) {
+            Clock::time_point t0 = Clock::now();
+            due += spawnsPerSecond * PHYSICS_TIME_STEP;
+            for (; due >= 1.0f; due -= 1.0f) {
+                if (count == maxLive) {
+                    pool.release(live[head]);
+                    head = (head + 1) % maxLive;
+                    count--;
+                }
+                seed = seed * 1664525u + 1013904223u;
+                float x = 1.0f + (seed >> 8) % (int)(width - 2.0f);
+                live[(head + count) % maxLive] = pool.acquire(x, 1.0f);
+                count++;
+                result.spawns++;
+            }
+            Clock::time_point t1 = Clock::now();
+            b2World_Step(worldId, PHYSICS_TIME_STEP, PHYSICS_SUB_STEPS);
+            Clock::time_point t2 = Clock::now();
+
+            result.churn += t1 - t0;
+            result.step += t2 - t1;
+        }
+
+        b2DestroyWorld(worldId);
+        return result;
+    }
+
+}
+
+/**
+ * @brief Run the food rain twice and print both timings
+ */
+int runFoodPoolBenchmark(int spawnsPerSecond, double seconds) {
+    int steps = (int)(seconds / PHYSICS_TIME_STEP + 0.5);
+    if (spawnsPerSecond <= 0 || steps <= 0) {
+        fprintf(stderr, "bench: need a positive spawn rate and duration\n");
+        return 1;
+    }
+
+    printf("food rain: %d spawns/sec for %.1f simulated seconds (%d steps)\n",
+        spawnsPerSecond, seconds, steps);
+    printf("  %-16s %10s %12s %12s %12s\n", "bodies", "spawns", "churn ms", "step ms", "us/spawn");
+
+    const bool modes[] = { false, true };
+    for (bool recycle : modes) {
+        FoodRainResult r = runFoodRain(recycle, spawnsPerSecond, steps);
+        double churnMs = std::chrono::duration<double, std::milli>(r.churn).count();
+        double stepMs = std::chrono::duration<double, std::milli>(r.step).count();
+        printf("  %-16s %10lld %12.2f %12.2f %12.3f\n", recycle ? "pooled" : "create/destroy",
+            r.spawns, churnMs, stepMs, r.spawns > 0 ? churnMs * 1000.0 / r.spawns : 0.0);
+    }
+    return 0;
+}
+
+/**
+ * @brief Replay a recorded session headless and compare world hashes
+ *
+ * Builds the world from the session header, applies each command at the
+ * step it was recorded in and checks the world hash after every step.
+ */
+int runReplay(const char* path, int workers) {
+    SessionReader reader;
+    SessionHeader header;
+    if (!reader.open(path, header)) {
+        fprintf(stderr, "replay: cannot read %s\n", path);
+        return 1;
+    }
+
+    TaskScheduler scheduler(workers);
+    GameWorld world;
+    world.create(header.worldWidth, header.worldHeight, header.spawnHeight, &scheduler, header.cats);
+    world.seedRandom(header.seed);
+    MemoryTag memoryTag(world.memoryTag);
+
+    const Clock::time_point start = Clock::now();
+    long long commandCount = 0;
+    long long steps = 0;
+    int result = 0;
+    for (;;) {
+        SessionReader::Record record = reader.next();
+        if (record == SessionReader::Record::End) break;
+        if (record == SessionReader::Record::Corrupt) {
+            fprintf(stderr, "replay: %s is corrupt after step %lld\n", path, steps);
+            result = 1;
+            break;
+        }
+        if (record == SessionReader::Record::Command) {
+            Command command;
+            command.type = reader.command();
+            world.apply(command);
+            commandCount++;
+            continue;
+        }
+
+        world.updateCats();
+        b2World_Step(world.worldId, PHYSICS_TIME_STEP, PHYSICS_SUB_STEPS);
+        world.eatTouchedFood();
+        steps = reader.step();
+
+        uint32_t hash = world.hash();
+        if (hash != reader.hash()) {
+            fprintf(stderr, "replay: diverged at step %lld (hash %08x, recorded %08x)\n",
+                steps, hash, reader.hash());
+            result = 1;
+            break;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("replay: %lld steps and %lld commands in %.3f s (%.1f steps/sec), %s\n",
+        steps, commandCount, elapsed, elapsed > 0.0 ? steps / elapsed : 0.0,
+        result == 0 ? "every step matches" : "FAILED");
+    printf("  seed %u, %d cats, meals eaten: %lld, poops made: %lld, poops cleaned: %lld\n",
+        header.seed, header.cats, world.meals, world.poopsMade, world.poopsCleaned);
+
+    world.destroy();
+    return result;
+}
+
+/**
+ * @brief Drive a PhysicsService through its controls and check the step counts
+ *
+ * stepN while running must be ignored instead of bursting after the next
+ * pause, a paused thread must not step on its own and stepN while paused
+ * must run exactly that many steps.
+ */
+int runControlsCheck() {
+    GameWorld world;
+    world.create(66.0f, 30.0f, 4);
+    TripleBuffer<RenderSnapshot> snapshots;
+    CommandQueue commands;
+    PhysicsService physics(world, snapshots, commands);
+    const PhysicsStats& stats = physics.stats();
+    auto settle = [] { std::this_thread::sleep_for(std::chrono::milliseconds(200)); };
+    int failures = 0;
+    auto expect = [&failures](bool ok, const char* what) {
+        printf("  %-40s %s\n", what, ok ? "ok" : "FAILED");
+        if (!ok) failures++;
+    };
+
+    printf("physics controls:\n");
+    physics.start();
+    settle();
+    expect(stats.stepCount.load() > 0, "steps while running");
+
+    // At most the catch-up steps already under way may finish after pause()
+    long long running = stats.stepCount.load();
+    physics.stepN(100);
+    physics.pause();
+    settle();
+    long long paused = stats.stepCount.load();
+    expect(paused - running <= PHYSICS_MAX_CATCHUP_STEPS, "stepN while running is not replayed");
+    settle();
+    expect(stats.stepCount.load() == paused, "no steps while paused");
+
+    physics.stepN(3);
+    settle();
+    expect(stats.stepCount.load() == paused + 3, "stepN(3) while paused runs 3 steps");
+
+    physics.resume();
+    settle();
+    expect(stats.stepCount.load() > paused + 3, "steps again after resume");
+
+    physics.stop();
+    world.destroy();
+    return failures > 0 ? 1 : 0;
+}
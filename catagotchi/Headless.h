@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file Headless.h
+ * @brief Render-less simulation of the game for soak tests and batch runs
+ *
+ * Runs the same Cat/Food/Poop logic and Box2D stepping as the curses game,
+ * but at a fixed step as fast as possible and without any curses calls.
+ */
+
+struct HeadlessOptions {
+    long long ticks = 0;        // stop after this many ticks (0 = no limit)
+    double seconds = 0.0;       // stop after this much wall time (0 = no limit)
+    int feedInterval = 30;      // ticks between automatic feedings
+    int pellets = 1;            // food dropped per feeding
+    float worldWidth = 66.0f;
+    float worldHeight = 30.0f;
+    int spawnHeight = 4;
+    int workers = 1;            // Box2D workers including the stepping thread
+    int cats = 1;
+    uint32_t seed = 1;          // food RNG seed
+    const char* record = nullptr;   // session file to record, see SessionLog.h
+    const char* save = nullptr;     // world save restored at start and written at exit
+    const char* trace = nullptr;    // Chrome trace JSON written at exit, see Trace.h
+};
+
+/**
+ * @brief Run the headless simulation and print ticks/sec and phase timings
+ * @param options What to simulate and for how long
+ * @return Process exit code
+ */
+int runHeadless(const HeadlessOptions& options);
+
+/**
+ * @brief Compare per-meal body create/destroy against the FoodBodyPool
+ * @param spawnsPerSecond Food spawned (and despawned) per simulated second
+ * @param seconds Simulated seconds per run
+ * @return Process exit code
+ *
+ * Models a "food rain": pellets fall onto the ground and the oldest ones are
+ * removed once too many are alive, at the given rate.
+ */
+int runFoodPoolBenchmark(int spawnsPerSecond, double seconds);
+
+/**
+ * @brief Re-run a recorded session as fast as possible and check every step
+ * @param path Session file written with --record
+ * @param workers Box2D workers including the stepping thread
+ * @return Process exit code, 1 if the replay diverged from the recording
+ */
+int runReplay(const char* path, int workers);
+
+/**
+ * @brief Check PhysicsService's pause, stepN and resume on a live thread
+ * @return Process exit code, 1 if a control misbehaved
+ *
+ * Takes about a second of wall time, the physics thread runs in real time.
+ */
+int runControlsCheck();
@@ -0,0 +1,61 @@
+#include "HeapCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @file HeapCounter.cpp
+ * @brief Replacement global operator new/delete that count allocations
+ */
+
+namespace {
+
+    std::atomic<long long> processCount{ 0 };
+    thread_local long long threadCount = 0;
+
+    void* countedAlloc(std::size_t size) {
+        processCount.fetch_add(1, std::memory_order_relaxed);
+        threadCount++;
+        return std::malloc(size ? size : 1);
+    }
+
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+/**
+ * @brief operator new calls on any thread since the start
+ */
+long long heapAllocations() {
+    return processCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief operator new calls on the calling thread since it started
+ */
+long long threadHeapAllocations() {
+    return threadCount;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * @file HeapCounter.h
+ * @brief Counts general heap allocations (operator new) per thread
+ *
+ * HeapCounter.cpp replaces the global operator new, so every new, every
+ * std::vector growth and every std::string that does not fit its small
+ * buffer is counted, both for the whole process and for the calling thread.
+ * Box2D's own memory goes through MemoryTracker instead and is not counted.
+ *
+ * Hot loops read threadHeapAllocations() before and after a frame or step
+ * to check that the steady state allocates nothing.
+ */
+
+long long heapAllocations();
+long long threadHeapAllocations();
@@ -1,56 +1,159 @@
 #include "InputHandler.h"
-#include <curses.h>
-#include <cstdlib>
-#include <memory>
-#include <box2d/box2d.h>
+#include "Trace.h"
+#include "Physics.h"
+#include <chrono>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 /**
- * @brief Constructs an InputHandler
+ * @brief Constructs an InputHandler, call start() to begin reading keys
+ * @param commands Queue of the physics thread
+ * @param running Cleared when the player quits
  */
+InputHandler::InputHandler(CommandQueue& commands, std::atomic<bool>& running)
+    : commands(commands), running(running) {
+}
 
-InputHandler::InputHandler(CatPtr cat, FoodPtr& food, PoopPtr& poop,
-    b2WorldId worldId, std::mutex& worldMu,
-    int virtualCols, int asciiHeight)
-    : cat(cat), food(food), poop(poop),
-    worldId(worldId), worldMu(worldMu),
-    virtualCols(virtualCols), asciiHeight(asciiHeight) {
+/**
+ * @brief Stops the input thread if it is still running
+ */
+InputHandler::~InputHandler() {
+    stop();
 }
 
 /**
- * @brief Checks keypresses and performs actions
+ * @brief Start the input thread
+ *
+ * Call after the terminal is in cbreak mode (curses' cbreak()), so keys
+ * arrive one at a time without waiting for Enter.
  */
-void InputHandler::handleInput(std::atomic<bool>& running) {
-    int ch = getch();
-    if (ch == 'q' || ch == 'Q') {
-        running = false;
-    }
-    else if ((ch == 'f' || ch == 'F') && (!food || !food->active)) {
-        spawnFood();
-    }
-    else if ((ch == 'c' || ch == 'C') && poop && poop->active) {
-        cleanPoop();
-    }
+void InputHandler::start() {
+    if (thread.joinable()) return;
+    thread = std::thread(&InputHandler::run, this);
+}
+
+/**
+ * @brief Wait for the input thread to notice shutdown
+ *
+ * Clear running first, the thread exits within TIMEOUT_MS.
+ */
+void InputHandler::stop() {
+    if (!thread.joinable()) return;
+    running = false;
+    thread.join();
 }
 
 /**
- * @brief Spawns food safely in the Box2D world
+ * @brief Write the trace to path when t is pressed, call before start()
+ * @param path Trace file, nullptr to ignore t
  */
-void InputHandler::spawnFood() {
-    std::lock_guard<std::mutex> lock(worldMu);
-    float fx = static_cast<float>(4 + rand() % (virtualCols - 8));
+void InputHandler::setTracePath(const char* path) {
+    tracePath = path;
+}
 
-    // Don't let food 2 drop on poop!
-    if (poop && poop->active && fx >= poop->x - 1 && fx <= poop->x + 1)
-        fx = poop->x + 2.0f;
+/**
+ * @brief Send the physics controls (pause, step, rate, save) here, call before start()
+ * @param service Physics thread, nullptr to ignore those keys
+ */
+void InputHandler::setPhysics(PhysicsService* service) {
+    physics = service;
+}
 
-    food = Food::spawn(worldId, fx, static_cast<float>(asciiHeight + 1));
+/**
+ * @brief Input thread: block for keys until the game stops
+ */
+void InputHandler::run() {
+    traceThread("input");
+    while (running.load()) {
+        int ch = readKey();
+        if (ch < 0) continue;
+        handleKey(ch, CommandQueue::now());
+    }
 }
 
 /**
- * @brief Removes poop safely from the Box2D world
+ * @brief Wait up to TIMEOUT_MS for one key from the console
+ * @return The key's character, or -1 if none arrived
+ *
+ * Keys without a character (arrows, function keys) come through as escape
+ * sequences on POSIX terminals and are skipped on Windows, no key uses them.
  */
-void InputHandler::cleanPoop() {
-    std::lock_guard<std::mutex> lock(worldMu);
-    b2DestroyBody(poop->bodyId);
-    poop->active = false;
+int InputHandler::readKey() {
+#ifdef _WIN32
+    HANDLE in = GetStdHandle(STD_INPUT_HANDLE);
+    if (WaitForSingleObject(in, TIMEOUT_MS) != WAIT_OBJECT_0) return -1;
+    INPUT_RECORD record;
+    DWORD count = 0;
+    if (!ReadConsoleInputA(in, &record, 1, &count) || count == 0) return -1;
+    if (record.EventType != KEY_EVENT || !record.Event.KeyEvent.bKeyDown) return -1;
+    char ch = record.Event.KeyEvent.uChar.AsciiChar;
+    return ch ? (unsigned char)ch : -1;
+#else
+    pollfd in{ STDIN_FILENO, POLLIN, 0 };
+    if (poll(&in, 1, TIMEOUT_MS) <= 0) return -1;
+    unsigned char ch;
+    if (read(STDIN_FILENO, &ch, 1) != 1) {
+        // stdin closed, poll would return at once from now on
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIMEOUT_MS));
+        return -1;
+    }
+    return ch;
+#endif
+}
+
+/**
+ * @brief Turn a keypress into a command
+ * @param ch Key read from the console
+ * @param timestamp When the key was read
+ */
+void InputHandler::handleKey(int ch, int64_t timestamp) {
+    TraceScope trace("key");
+    keys++;
+    if (ch == 'q' || ch == 'Q') {
+        running = false;
+    }
+    else if (ch == 'f' || ch == 'F') {
+        commands.push(CommandType::SpawnFood, timestamp);
+    }
+    else if (ch == 'c' || ch == 'C') {
+        commands.push(CommandType::CleanPoop, timestamp);
+    }
+    else if ((ch == 't' || ch == 'T') && tracePath) {
+        // Written from here so neither the physics nor the render loop stalls
+        if (traceWrite(tracePath)) traces++;
+    }
+    else if (ch == ']' || ch == '\t') {
+        selected.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (ch == '[') {
+        selected.fetch_sub(1, std::memory_order_relaxed);
+    }
+    else if (ch == 'p' || ch == 'P') {
+        overlay.store(!overlay.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    else if (!physics) {
+        return;
+    }
+    else if (ch == ' ') {
+        if (physics->isPaused()) physics->resume();
+        else physics->pause();
+    }
+    else if (ch == 'n' || ch == 'N') {
+        if (physics->isPaused()) physics->stepN(1);
+    }
+    else if (ch == '+' || ch == '=') {
+        physics->setTargetRate(b2MinFloat(physics->targetRate() * 2.0f, PHYSICS_MAX_RATE));
+    }
+    else if (ch == '-') {
+        physics->setTargetRate(b2MaxFloat(physics->targetRate() * 0.5f, PHYSICS_MIN_RATE));
+    }
+    else if (ch == 's' || ch == 'S') {
+        physics->requestSave();
+    }
 }
@@ -1,36 +1,61 @@
 #pragma once
-#include <box2d/box2d.h>
-#include <memory>
-#include <mutex>
-#include "Catagotchi.h"
+#include <atomic>
+#include <thread>
+#include "CommandQueue.h"
+
+class PhysicsService;
 
 /**
  * @brief Handles user input for the CatAGotchi demo
  *
- * This class checks keypresses and performs actions such as spawning food
- * or cleaning poop. It interacts with the Box2D world safely using a mutex.
+ * This class reads keypresses on its own thread and turns them into commands
+ * such as spawning food or cleaning poop. With a PhysicsService set, space
+ * pauses and resumes physics, n runs one step while paused, + and - double
+ * and halve the step rate and s saves right away. With a trace file set, t writes
+ * the trace recorded so far (see Trace.h). The thread blocks on the console
+ * until a key arrives (with a timeout so it notices shutdown), stamps the
+ * command with the time the key was read and pushes it straight into the
+ * lock-free command queue of the physics thread. Input never touches the
+ * Box2D world and the render loop never polls the keyboard.
+ *
+ * Curses is not thread-safe and wgetch refreshes its window, so the thread
+ * does not use curses at all: it reads stdin with poll/read (the console
+ * input buffer on Windows) and every curses call stays on the render thread.
  */
 class InputHandler {
 public:
-    InputHandler(CatPtr cat, FoodPtr& food, PoopPtr& poop,
-        b2WorldId worldId, std::mutex& worldMu, int virtualCols, int asciiHeight);
+    // How long a read blocks before checking for shutdown
+    static constexpr int TIMEOUT_MS = 100;
+
+    InputHandler(CommandQueue& commands, std::atomic<bool>& running);
+    ~InputHandler();
 
+    InputHandler(const InputHandler&) = delete;
+    InputHandler& operator=(const InputHandler&) = delete;
 
-    /**
-     * @brief Checks keypresses and handles commands
-     * @param running Atomic boolean to control main loop
-     */
-    void handleInput(std::atomic<bool>& running);
+    void start();
+    void stop();
+
+    void setTracePath(const char* path);
+    void setPhysics(PhysicsService* service);
+
+    long long keysRead() const { return keys.load(); }
+    long long tracesWritten() const { return traces.load(); }
+    bool overlayShown() const { return overlay.load(std::memory_order_relaxed); }
+    int selectedCat() const { return selected.load(std::memory_order_relaxed); }
 
 private:
-    CatPtr cat;
-    FoodPtr& food;
-    PoopPtr& poop;
-    b2WorldId worldId;
-    std::mutex& worldMu;
-    int virtualCols;
-    int asciiHeight;
-
-    void spawnFood();
-    void cleanPoop();
+    CommandQueue& commands;
+    std::atomic<bool>& running;
+    std::atomic<long long> keys{ 0 };
+    std::atomic<bool> overlay{ false };   // toggled with p, read by the render loop
+    std::atomic<long long> traces{ 0 };
+    std::atomic<int> selected{ 0 };        // cat the camera follows, [ and ] change it
+    const char* tracePath = nullptr;
+    PhysicsService* physics = nullptr;
+    std::thread thread;
+
+    void run();
+    int readKey();
+    void handleKey(int ch, int64_t timestamp);
 };
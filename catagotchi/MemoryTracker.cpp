@@ -0,0 +1,155 @@
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include <box2d/box2d.h>
+
+/**
+ * @file MemoryTracker.cpp
+ * @brief Implementation of the tracking allocator
+ */
+
+namespace {
+
+    // Keeps the block after it aligned, Box2D asks for 32 byte alignment
+    constexpr unsigned HEADER_SIZE = 32;
+
+    struct BlockHeader {
+        uint32_t size;
+        int32_t tag;
+    };
+
+    struct TagCounters {
+        std::atomic<long long> live{ 0 };
+        std::atomic<long long> peak{ 0 };
+        std::atomic<long long> allocations{ 0 };
+        std::atomic<long long> frees{ 0 };
+    };
+
+    TagCounters tags[MEMORY_MAX_TAGS];
+    TagCounters total;
+    std::atomic<int> nextTag{ 1 };
+
+    thread_local int currentTag = 0;
+
+    /**
+     * @brief Raise peak to value if it is higher
+     */
+    void raisePeak(std::atomic<long long>& peak, long long value) {
+        long long seen = peak.load(std::memory_order_relaxed);
+        while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void charge(TagCounters& counters, long long size) {
+        long long live = counters.live.fetch_add(size, std::memory_order_relaxed) + size;
+        raisePeak(counters.peak, live);
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void refund(TagCounters& counters, long long size) {
+        counters.live.fetch_sub(size, std::memory_order_relaxed);
+        counters.frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief b2AllocFcn: allocate with a header in front of the block
+     * @param size Bytes, Box2D already rounded it up to a multiple of 32
+     * @param alignment Always 32 from Box2D
+     */
+    void* trackedAlloc(unsigned int size, int alignment) {
+        (void)alignment;
+        unsigned int blockSize = size + HEADER_SIZE;
+#ifdef _WIN32
+        char* base = static_cast<char*>(_aligned_malloc(blockSize, HEADER_SIZE));
+#else
+        char* base = static_cast<char*>(aligned_alloc(HEADER_SIZE, blockSize));
+#endif
+        if (!base) return nullptr;
+
+        int tag = currentTag;
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(base);
+        header->size = size;
+        header->tag = tag;
+        charge(tags[tag], size);
+        charge(total, size);
+        return base + HEADER_SIZE;
+    }
+
+    /**
+     * @brief b2FreeFcn: charge the block back to its tag and free it
+     */
+    void trackedFree(void* mem) {
+        char* base = static_cast<char*>(mem) - HEADER_SIZE;
+        const BlockHeader* header = reinterpret_cast<const BlockHeader*>(base);
+        refund(tags[header->tag], header->size);
+        refund(total, header->size);
+#ifdef _WIN32
+        _aligned_free(base);
+#else
+        free(base);
+#endif
+    }
+
+    MemoryStats read(const TagCounters& counters) {
+        MemoryStats stats;
+        stats.liveBytes = counters.live.load(std::memory_order_relaxed);
+        stats.peakBytes = counters.peak.load(std::memory_order_relaxed);
+        stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+        stats.frees = counters.frees.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+}
+
+/**
+ * @brief Route Box2D's allocations through the tracker
+ *
+ * Call once at startup, before any world is created: blocks allocated
+ * before have no header and must not reach trackedFree().
+ */
+void memoryInstall() {
+    b2SetAllocator(&trackedAlloc, &trackedFree);
+}
+
+/**
+ * @brief Reserve a tag for a new world
+ * @return The tag, or 0 once all tags are taken
+ */
+int memoryNewTag() {
+    int tag = nextTag.fetch_add(1, std::memory_order_relaxed);
+    return tag < MEMORY_MAX_TAGS ? tag : 0;
+}
+
+/**
+ * @brief Counters of one tag
+ * @param tag From memoryNewTag(), or 0 for untagged memory
+ */
+MemoryStats memoryStats(int tag) {
+    if (tag < 0 || tag >= MEMORY_MAX_TAGS) return MemoryStats{};
+    return read(tags[tag]);
+}
+
+/**
+ * @brief Counters over all tags, the peak is the peak of the sum
+ */
+MemoryStats memoryTotal() {
+    return read(total);
+}
+
+/**
+ * @brief Charge the calling thread's allocations to tag until destroyed
+ * @param tag From memoryNewTag()
+ */
+MemoryTag::MemoryTag(int tag) : previous(currentTag) {
+    currentTag = tag >= 0 && tag < MEMORY_MAX_TAGS ? tag : 0;
+}
+
+/**
+ * @brief Go back to the tag that was current before
+ */
+MemoryTag::~MemoryTag() {
+    currentTag = previous;
+}
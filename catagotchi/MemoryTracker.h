@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file MemoryTracker.h
+ * @brief Counts Box2D's heap memory per world through b2SetAllocator
+ *
+ * memoryInstall() routes every Box2D allocation through a tracking
+ * allocator. Each block carries a small header with its size and the tag
+ * that was current on the allocating thread, so frees are charged back to
+ * the right tag whichever thread frees them. Code that works on a world
+ * sets that world's tag with a MemoryTag scope; GameWorld takes a tag of
+ * its own in create(). Allocations made on Box2D's worker threads or
+ * outside any scope land on tag 0 (untagged).
+ *
+ * All counters are relaxed atomics, so reading them from the render loop
+ * or another thread never blocks an allocation.
+ */
+
+// Tag 0 is untagged, worlds get 1 .. MEMORY_MAX_TAGS - 1 (B2_MAX_WORLDS + 1)
+constexpr int MEMORY_MAX_TAGS = 129;
+
+struct MemoryStats {
+    long long liveBytes = 0;     // allocated and not freed yet
+    long long peakBytes = 0;     // highest liveBytes so far
+    long long allocations = 0;   // allocations so far, for rates
+    long long frees = 0;
+};
+
+void memoryInstall();
+int memoryNewTag();
+MemoryStats memoryStats(int tag);
+MemoryStats memoryTotal();
+
+/**
+ * @brief Charges Box2D allocations of the calling thread to a tag while in scope
+ */
+class MemoryTag {
+public:
+    explicit MemoryTag(int tag);
+    ~MemoryTag();
+
+    MemoryTag(const MemoryTag&) = delete;
+    MemoryTag& operator=(const MemoryTag&) = delete;
+
+private:
+    int previous;
+};
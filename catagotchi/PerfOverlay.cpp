@@ -0,0 +1,67 @@
+#include "PerfOverlay.h"
+#include <cstdio>
+
+/**
+ * @file PerfOverlay.cpp
+ * @brief Implementation of the PerfOverlay
+ */
+
+/**
+ * @brief Mark the start of drawing a frame
+ */
+void PerfOverlay::beginRender() {
+    renderStart = Clock::now();
+}
+
+/**
+ * @brief Fold the time since beginRender() into the render time average
+ */
+void PerfOverlay::endRender() {
+    float ms = std::chrono::duration<float, std::milli>(Clock::now() - renderStart).count();
+    renderMs += RENDER_SMOOTHING * (ms - renderMs);
+}
+
+/**
+ * @brief Rebuild the overlay text if it is due
+ * @param perf Physics averages from the latest snapshot
+ * @param stats Live numbers of the physics thread
+ * @param memory Box2D memory of the world
+ * @param arena The frame's arena, the text lives in it until the frame ends
+ * @return True if lines() were rebuilt, hand them to the Renderer this frame
+ */
+bool PerfOverlay::update(const PhysicsPerf& perf, const PhysicsStats& stats, const MemoryStats& memory, FrameArena& arena) {
+    Clock::time_point now = Clock::now();
+    if (shown && now - lastUpdate < std::chrono::milliseconds(OVERLAY_REFRESH_MS)) return false;
+    float seconds = std::chrono::duration<float>(now - lastUpdate).count();
+    float allocationRate = lastAllocations >= 0 && seconds > 0.0f ? (memory.allocations - lastAllocations) / seconds : 0.0f;
+    lastAllocations = memory.allocations;
+    lastUpdate = now;
+
+    char** text = arena.alloc<char*>(LINES);
+    for (int i = 0; i < LINES; ++i)
+        text[i] = arena.alloc<char>(LINE_LENGTH);
+    snprintf(text[0], LINE_LENGTH, " step %6.3f ms  collide %6.3f  solve %6.3f ", perf.step, perf.collide, perf.solve);
+    snprintf(text[1], LINE_LENGTH, " sensors %6.3f ms  sleep islands %6.3f     ", perf.sensors, perf.sleepIslands);
+    snprintf(text[2], LINE_LENGTH, " bodies %5.0f  contacts %5.0f  awake islands %4.0f  tasks %3.0f ",
+        perf.bodies, perf.contacts, perf.awakeIslands, perf.tasks);
+    snprintf(text[3], LINE_LENGTH, " render %6.3f ms  input to effect %6.2f ms ", renderMs, perf.inputMs);
+    snprintf(text[4], LINE_LENGTH, " box2d %8.1f KB  peak %8.1f KB  %6.1f allocs/s ",
+        memory.liveBytes / 1024.0, memory.peakBytes / 1024.0, allocationRate);
+    snprintf(text[5], LINE_LENGTH, " physics %5.1f steps/s  lag %5.2f ms  overruns %lld ",
+        stats.stepRate.load(), stats.lagMs.load(), stats.overruns.load());
+    snprintf(text[6], LINE_LENGTH, " last second: step avg %6.3f ms  p99 %6.3f  awake bodies %5d ",
+        stats.avgStepMs.load(), stats.p99StepMs.load(), stats.awakeBodies.load());
+    frameLines = text;
+    shown = true;
+    return true;
+}
+
+/**
+ * @brief Forget the render average, for when the overlay is hidden
+ */
+void PerfOverlay::reset() {
+    frameLines = nullptr;
+    shown = false;
+    renderMs = 0.0f;
+    lastAllocations = -1;
+}
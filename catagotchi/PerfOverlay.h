@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include "RenderSnapshot.h"
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include "Physics.h"
+
+/**
+ * @file PerfOverlay.h
+ * @brief Text for the perf overlay toggled with the p key
+ *
+ * Turns the rolling physics averages carried by each RenderSnapshot, the
+ * fixed-step scheduler's PhysicsStats, the render loop's own draw time and
+ * the world's Box2D memory into a few lines of text for the Renderer.
+ * The text changes at most OVERLAY_REFRESH_MS apart so the numbers stay
+ * readable and the overlay does not cost a terminal write every frame. While
+ * the overlay is hidden nothing here runs.
+ */
+class PerfOverlay {
+public:
+    static constexpr int OVERLAY_REFRESH_MS = 250;
+    static constexpr int LINES = 7;
+    static constexpr int LINE_LENGTH = 96;
+    // Weight of the newest frame in the render time average
+    static constexpr float RENDER_SMOOTHING = 0.1f;
+
+    void beginRender();
+    void endRender();
+    bool update(const PhysicsPerf& perf, const PhysicsStats& stats, const MemoryStats& memory, FrameArena& arena);
+    void reset();
+
+    /** @brief Text from the last update(), valid until its arena is reset */
+    const char* const* lines() const { return frameLines; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point renderStart;
+    Clock::time_point lastUpdate;
+    float renderMs = 0.0f;
+    long long lastAllocations = -1;
+    bool shown = false;
+    char** frameLines = nullptr;
+};
@@ -1,26 +1,331 @@
 #include "Physics.h"
-#include <thread>
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include "HeapCounter.h"
+#include "SpriteAtlas.h"
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 /**
- * @brief Starts a separate thread to advance the Box2D world
- * @param worldId Box2D world
- * @param running Atomic flag to control the loop
- * @param worldMu Mutex to serialize Box2D calls
+ * @file Physics.cpp
+ * @brief Implementation of the PhysicsService
+ */
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Constructs a stopped PhysicsService
+ * @param world Game world (Box2D world, cat, food and poop)
+ * @param snapshots Receives a render frame after every step
+ * @param commands Commands to apply at the start of every step
+ */
+PhysicsService::PhysicsService(GameWorld& world, TripleBuffer<RenderSnapshot>& snapshots,
+    CommandQueue& commands)
+    : world(world), snapshots(snapshots), commands(commands) {
+}
+
+/**
+ * @brief Stops and joins the thread if it is still running
+ */
+PhysicsService::~PhysicsService() {
+    stop();
+}
+
+/**
+ * @brief Starts the physics thread
+ */
+void PhysicsService::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&PhysicsService::run, this);
+}
+
+/**
+ * @brief Asks the thread to finish and waits until it has
+ *
+ * Returns only after the last step is done, so the world may be destroyed
+ * right after.
+ */
+void PhysicsService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(controlMu);
+        running = false;
+    }
+    controlCv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+/**
+ * @brief Stops stepping until resume() or stepN() is called
+ */
+void PhysicsService::pause() {
+    std::lock_guard<std::mutex> lock(controlMu);
+    paused = true;
+    pendingSteps = 0;
+}
+
+/**
+ * @brief Continues real-time stepping after pause()
+ */
+void PhysicsService::resume() {
+    {
+        std::lock_guard<std::mutex> lock(controlMu);
+        paused = false;
+        pendingSteps = 0;
+    }
+    controlCv.notify_all();
+}
+
+/**
+ * @brief Runs exactly count steps while paused
+ * @param count Number of steps
+ *
+ * Ignored while running, so the steps cannot pile up and run in one burst
+ * after the next pause().
+ */
+void PhysicsService::stepN(int count) {
+    {
+        std::lock_guard<std::mutex> lock(controlMu);
+        if (!paused || count <= 0) return;
+        pendingSteps += count;
+    }
+    controlCv.notify_all();
+}
+
+/**
+ * @brief Sets how many steps are run per second of wall time
+ * @param stepsPerSecond Target rate, 60 is real time
+ *
+ * The simulated time per step stays PHYSICS_TIME_STEP, so a lower rate
+ * throttles physics (slow motion) instead of taking bigger steps.
+ */
+void PhysicsService::setTargetRate(float stepsPerSecond) {
+    if (stepsPerSecond <= 0.0f) return;
+    {
+        std::lock_guard<std::mutex> lock(controlMu);
+        rate = stepsPerSecond;
+    }
+    controlCv.notify_all();
+}
+
+/**
+ * @brief Record every step from now on, call before start()
+ * @param sessionRecorder Open recorder, or nullptr to stop recording
+ */
+void PhysicsService::setRecorder(SessionRecorder* sessionRecorder) {
+    recorder = sessionRecorder;
+}
+
+/**
+ * @brief Save the world every PHYSICS_AUTOSAVE_STEPS steps, call before start()
+ * @param worldSaver Saver thread, or nullptr to stop saving
+ */
+void PhysicsService::setSaver(WorldSaver* worldSaver) {
+    saver = worldSaver;
+}
+
+/**
+ * @brief Save the world after the next step, safe to call from any thread
+ */
+void PhysicsService::requestSave() {
+    saveRequested = true;
+}
+
+/**
+ * @brief Collect b2Profile and b2Counters averages into every snapshot
+ * @param enabled False stops collecting and zeroes the averages
+ *
+ * Safe to call from any thread, it takes effect from the next step.
+ */
+void PhysicsService::setProfiling(bool enabled) {
+    profiling.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Tell the physics thread what the render loop can show
+ * @param cols Terminal columns
+ * @param rows Terminal rows
+ * @param selectedCat Cat the camera follows, any value, it wraps around
+ *
+ * Safe to call from any thread every frame, snapshots only hold what is in
+ * view from the next step on.
+ */
+void PhysicsService::setViewport(int cols, int rows, int selectedCat) {
+    viewCols.store(cols, std::memory_order_relaxed);
+    viewRows.store(rows, std::memory_order_relaxed);
+    viewCat.store(selectedCat, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Fold the last step's profile and counters into the rolling averages
+ */
+void PhysicsService::updatePerf() {
+    const float a = PHYSICS_PERF_SMOOTHING;
+    auto blend = [a](float& average, float value) { average += a * (value - average); };
+
+    b2Profile profile = b2World_GetProfile(world.worldId);
+    b2Counters counters = b2World_GetCounters(world.worldId);
+    blend(perf.step, profile.step);
+    blend(perf.collide, profile.collide);
+    blend(perf.solve, profile.solve);
+    blend(perf.sensors, profile.sensors);
+    blend(perf.sleepIslands, profile.sleepIslands);
+    blend(perf.bodies, (float)counters.bodyCount);
+    blend(perf.contacts, (float)counters.contactCount);
+    blend(perf.awakeIslands, (float)counters.islandCount);
+    blend(perf.tasks, (float)counters.taskCount);
+
+    // Input latency only changes when a command was applied
+    const CommandLatencyLog& latency = world.commandLatency;
+    if (latency.count != latencyCount) {
+        latencyCount = latency.count;
+        int64_t last = latency.latencies[(latency.count - 1) % CommandLatencyLog::CAPACITY];
+        blend(perf.inputMs, last / 1e6f);
+    }
+}
+
+/**
+ * @brief Advances the game world by one fixed step
+ * @return Box2D step time from b2Profile in milliseconds
+ */
+float PhysicsService::stepOnce() {
+    TraceScope trace("step");
+    MemoryTag tag(world.memoryTag);
+    long long heapAtStart = threadHeapAllocations();
+    long long commandsBefore = world.commandLatency.count;
+    long long mealsBefore = world.meals;
+    world.applyCommands(commands, recorder);
+    world.updateCats();
+    int awakeBodies = b2World_GetAwakeBodyCount(world.worldId);
+    int64_t stepStart = traceEnabled() ? traceNow() : 0;
+    b2World_Step(world.worldId, PHYSICS_TIME_STEP, PHYSICS_SUB_STEPS);
+    if (traceEnabled()) traceWorldStep(world.worldId, stepStart, traceNow());
+    world.eatTouchedFood();
+    if (recorder) recorder->endStep(world.hash());
+
+    RenderSnapshot& frame = snapshots.writeBuffer();
+    Viewport view;
+    view.cols = viewCols.load(std::memory_order_relaxed);
+    view.rows = viewRows.load(std::memory_order_relaxed);
+    view.selectedCat = viewCat.load(std::memory_order_relaxed);
+    world.snapshot(frame, ++stepIndex, view);
+
+    // Anything moved, was added or removed, the view changed or an animation
+    // may turn to its next frame: the render loop has something to draw
+    bool viewChanged = view.cols != lastView.cols || view.rows != lastView.rows ||
+        view.selectedCat != lastView.selectedCat;
+    if (awakeBodies > 0 || world.commandLatency.count != commandsBefore || world.meals != mealsBefore ||
+        viewChanged || stepIndex % SpriteAtlas::ANIMATION_STEPS == 0)
+        contentVersion++;
+    lastView = view;
+    frame.contentVersion = contentVersion;
+    if (profiling.load(std::memory_order_relaxed)) updatePerf();
+    else if (perf.step != 0.0f) perf = PhysicsPerf{};
+    frame.perf = perf;
+    snapshots.publish();
+
+    // Capture between steps, the saver thread writes the file. If it is
+    // still busy with the last save, try again after the next step.
+    if (saver) {
+        if (stepIndex % PHYSICS_AUTOSAVE_STEPS == 0) saveRequested = true;
+        if (saveRequested.load()) {
+            if (WorldSave* save = saver->beginCapture()) {
+                world.capture(*save);
+                saver->submit();
+                saveRequested = false;
+            }
+        }
+    }
+
+    long long allocations = threadHeapAllocations() - heapAtStart;
+    if (allocations > 0) {
+        physicsStats.heapAllocations += allocations;
+        physicsStats.allocatingSteps++;
+        physicsStats.lastAllocatingStep = stepIndex;
+    }
+    physicsStats.stepCount++;
+    physicsStats.awakeBodies = b2World_GetAwakeBodyCount(world.worldId);
+    return b2World_GetProfile(world.worldId).step;
+}
+
+/**
+ * @brief The thread body: a fixed-step scheduler
  *
- * Demonstrates multi-threading with a lambda function.
+ * Accumulates real elapsed time and runs as many fixed steps as fit in it,
+ * so the simulation keeps real time even when a step takes longer. If it
+ * falls more than PHYSICS_MAX_CATCHUP_STEPS behind, the extra time is
+ * dropped and counted as an overrun instead of spiraling.
  */
-void startPhysicsThread(b2WorldId worldId, std::atomic<bool>& running, std::mutex& worldMu) {
-    const float timeStep = 1.0f / 60.0f;
-    const int subSteps = 4;
+void PhysicsService::run() {
+    traceThread("physics");
+    Clock::time_point previous = Clock::now();
+    Clock::time_point statsStart = previous;
+    Clock::duration accumulator{};
+    long long statsSteps = 0;
+    std::vector<float> stepTimes;
+    stepTimes.reserve(1024);
+
+    std::unique_lock<std::mutex> lock(controlMu);
+    while (running.load()) {
+        Clock::duration step = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / rate.load()));
 
-    std::thread([=, &running, &worldMu]() {
-        while (running.load()) {
-            {
-                std::lock_guard<std::mutex> lock(worldMu);
-                b2World_Step(worldId, timeStep, subSteps);
+        int steps = 0;
+        if (paused.load()) {
+            // Only explicitly requested steps while paused
+            controlCv.wait(lock, [this] { return !running || !paused || pendingSteps > 0; });
+            if (!running || !paused) {
+                previous = Clock::now();
+                accumulator = Clock::duration{};
+                continue;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            steps = pendingSteps.exchange(0);
+            lock.unlock();
+            for (int i = 0; i < steps; ++i) stepTimes.push_back(stepOnce());
+            lock.lock();
+        }
+        else {
+            lock.unlock();
+            Clock::time_point now = Clock::now();
+            accumulator += now - previous;
+            previous = now;
+
+            while (accumulator >= step && steps < PHYSICS_MAX_CATCHUP_STEPS) {
+                stepTimes.push_back(stepOnce());
+                accumulator -= step;
+                steps++;
+            }
+            if (accumulator >= step) {
+                // Too far behind, give up on the missed time
+                accumulator = Clock::duration{};
+                physicsStats.overruns++;
+            }
+            physicsStats.lagMs = std::chrono::duration<float, std::milli>(accumulator).count();
+            lock.lock();
+        }
+
+        // Publish rate and step time percentiles once per second
+        statsSteps += steps;
+        Clock::time_point now = Clock::now();
+        if (now - statsStart >= std::chrono::seconds(1)) {
+            physicsStats.stepRate = statsSteps / std::chrono::duration<float>(now - statsStart).count();
+            if (!stepTimes.empty()) {
+                float sum = 0.0f;
+                for (float t : stepTimes) sum += t;
+                size_t p99 = (stepTimes.size() * 99) / 100;
+                std::nth_element(stepTimes.begin(), stepTimes.begin() + p99, stepTimes.end());
+                physicsStats.avgStepMs = sum / stepTimes.size();
+                physicsStats.p99StepMs = stepTimes[p99];
+                stepTimes.clear();
+            }
+            statsStart = now;
+            statsSteps = 0;
+        }
+
+        // Sleep until the next step is due, waking early for stop/pause/rate changes
+        if (!paused.load()) {
+            Clock::time_point due = previous + (step - accumulator);
+            controlCv.wait_until(lock, due);
         }
-        }).detach();
-}
\ No newline at end of file
+    }
+}
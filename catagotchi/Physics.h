@@ -2,12 +2,117 @@
 #include <box2d/box2d.h>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "GameWorld.h"
+#include "RenderSnapshot.h"
+#include "CommandQueue.h"
+#include "SessionLog.h"
+#include "WorldSave.h"
 
 /**
  * @file Physics.h
- * @brief A threadable function for physics management
+ * @brief The physics thread and its controls
  *
- * Contains a function to start a Box2D physics thread loop
- * demonstrating multi-threading
+ * PhysicsService owns the thread that advances the game world. It can be
+ * started, paused, single-stepped, throttled and stopped, and reports how
+ * the simulation is doing.
  */
-void startPhysicsThread(b2WorldId worldId, std::atomic<bool>& running, std::mutex& worldMu);
+
+// Fixed step used by both the physics thread and the headless simulation
+constexpr float PHYSICS_TIME_STEP = 1.0f / 60.0f;
+constexpr int PHYSICS_SUB_STEPS = 4;
+
+// Range of PhysicsService::setTargetRate() offered to the player (steps per second)
+constexpr float PHYSICS_MIN_RATE = 7.5f;
+constexpr float PHYSICS_MAX_RATE = 480.0f;
+
+// Most steps the physics thread runs in one go to catch up after a stall
+constexpr int PHYSICS_MAX_CATCHUP_STEPS = 5;
+
+// Weight of the newest step in the profiling averages
+constexpr float PHYSICS_PERF_SMOOTHING = 0.05f;
+
+// Steps between automatic saves when a WorldSaver is set (one minute)
+constexpr int PHYSICS_AUTOSAVE_STEPS = 60 * 60;
+
+/**
+ * @brief Live numbers from the physics thread
+ */
+struct PhysicsStats {
+    std::atomic<float> stepRate{ 0.0f };     // measured steps per second
+    std::atomic<long long> stepCount{ 0 };   // steps since start
+    std::atomic<long long> overruns{ 0 };    // times the catch-up cap dropped time
+    std::atomic<float> lagMs{ 0.0f };        // real time not simulated yet
+    std::atomic<float> avgStepMs{ 0.0f };    // b2Profile step time, last second
+    std::atomic<float> p99StepMs{ 0.0f };    // b2Profile step time, last second
+    std::atomic<int> awakeBodies{ 0 };       // awake bodies after the last step
+    std::atomic<long long> heapAllocations{ 0 };     // operator new calls during steps
+    std::atomic<long long> allocatingSteps{ 0 };     // steps that made any
+    std::atomic<long long> lastAllocatingStep{ 0 };
+};
+
+/**
+ * @brief Runs the game world on its own joinable thread
+ *
+ * Every step applies the queued commands, runs the cat AI, advances Box2D,
+ * lets cats eat what touched them and publishes a RenderSnapshot. The
+ * thread is the only one that touches the world while it runs, so the world
+ * can be destroyed safely after stop().
+ */
+class PhysicsService {
+public:
+    PhysicsService(GameWorld& world, TripleBuffer<RenderSnapshot>& snapshots, CommandQueue& commands);
+    ~PhysicsService();
+
+    PhysicsService(const PhysicsService&) = delete;
+    PhysicsService& operator=(const PhysicsService&) = delete;
+
+    void start();
+    void stop();
+    void pause();
+    void resume();
+    void stepN(int count);
+    void setTargetRate(float stepsPerSecond);
+    void setRecorder(SessionRecorder* sessionRecorder);
+    void setSaver(WorldSaver* worldSaver);
+    void requestSave();
+    void setProfiling(bool enabled);
+    void setViewport(int cols, int rows, int selectedCat);
+
+    bool isPaused() const { return paused.load(); }
+    bool isProfiling() const { return profiling.load(std::memory_order_relaxed); }
+    float targetRate() const { return rate.load(); }
+    const PhysicsStats& stats() const { return physicsStats; }
+
+private:
+    GameWorld& world;
+    TripleBuffer<RenderSnapshot>& snapshots;
+    CommandQueue& commands;
+    SessionRecorder* recorder = nullptr;
+    WorldSaver* saver = nullptr;
+
+    std::thread thread;
+    std::mutex controlMu;
+    std::condition_variable controlCv;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> paused{ false };
+    std::atomic<int> pendingSteps{ 0 };
+    std::atomic<float> rate{ 60.0f };
+    std::atomic<bool> saveRequested{ false };
+    std::atomic<bool> profiling{ false };
+    std::atomic<int> viewCols{ 0 };
+    std::atomic<int> viewRows{ 0 };
+    std::atomic<int> viewCat{ 0 };
+
+    PhysicsStats physicsStats;
+    long long stepIndex = 0;
+    long long contentVersion = 0;
+    Viewport lastView{ -1, -1, 0 };
+    PhysicsPerf perf;
+    long long latencyCount = 0;
+
+    void run();
+    float stepOnce();
+    void updatePerf();
+};
@@ -0,0 +1,93 @@
+#include "RenderPacer.h"
+#include "HeapCounter.h"
+#include <thread>
+
+/**
+ * @file RenderPacer.cpp
+ * @brief Implementation of the RenderPacer
+ */
+
+ /**
+  * @brief Constructs a pacer
+  * @param targetFps Frames per second to aim for, at least 1
+  */
+RenderPacer::RenderPacer(int targetFps)
+    : fps(targetFps > 0 ? targetFps : 1),
+    period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))) {
+}
+
+/**
+ * @brief Mark the start of a frame's work
+ */
+void RenderPacer::beginFrame() {
+    frameStart = Clock::now();
+    heapAtFrameStart = threadHeapAllocations();
+    if (!started) {
+        nextFrame = frameStart;
+        started = true;
+    }
+}
+
+/**
+ * @brief Record the frame and sleep for the rest of its budget
+ * @param frameDrawn False if the frame was skipped because nothing changed
+ *
+ * A frame that ends after the next one was due counts the missed frames as
+ * dropped and restarts the schedule from now instead of trying to catch up.
+ */
+void RenderPacer::endFrame(bool frameDrawn) {
+    Clock::time_point now = Clock::now();
+    long long allocations = threadHeapAllocations() - heapAtFrameStart;
+    if (allocations > 0) {
+        frameAllocations += allocations;
+        allocatingFrames++;
+        lastAllocatingFrame = drawn + skipped + 1;
+    }
+    if (frameDrawn) {
+        long long us = std::chrono::duration_cast<std::chrono::microseconds>(now - frameStart).count();
+        long long bucket = us / BUCKET_US;
+        histogram[bucket < BUCKETS ? bucket : BUCKETS]++;
+        drawn++;
+    }
+    else {
+        skipped++;
+    }
+
+    nextFrame += period;
+    if (now > nextFrame) {
+        dropped += (now - nextFrame) / period + 1;
+        nextFrame = now;
+        return;
+    }
+    std::this_thread::sleep_until(nextFrame);
+}
+
+/**
+ * @brief Print frame counts and frame time percentiles
+ * @param out Stream to print to
+ */
+void RenderPacer::report(FILE* out) const {
+    fprintf(out, "render: %lld frames drawn, %lld skipped (nothing changed), %lld dropped at %d fps\n",
+        drawn, skipped, dropped, fps);
+    if (drawn > 0)
+        fprintf(out, "  frame time p50 %.1f ms, p95 %.1f ms, p99 %.1f ms\n",
+            percentileMs(0.50), percentileMs(0.95), percentileMs(0.99));
+    fprintf(out, "  %lld heap allocations in %lld of %lld frames, the last in frame %lld\n",
+        frameAllocations, allocatingFrames, drawn + skipped, lastAllocatingFrame);
+}
+
+/**
+ * @brief Read a percentile of the drawn frames' work time from the histogram
+ * @param fraction Percentile as a fraction, e.g. 0.99
+ * @return Upper edge of the bucket holding the percentile, in milliseconds
+ */
+double RenderPacer::percentileMs(double fraction) const {
+    long long rank = (long long)(fraction * (drawn - 1));
+    long long seen = 0;
+    int bucket = 0;
+    for (; bucket < BUCKETS; ++bucket) {
+        seen += histogram[bucket];
+        if (seen > rank) break;
+    }
+    return (bucket + 1) * BUCKET_US / 1000.0;
+}
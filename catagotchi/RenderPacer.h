@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+/**
+ * @file RenderPacer.h
+ * @brief Keeps the render loop at a target frame rate and measures frame times
+ *
+ * Each frame sleeps only for what is left of its budget after drawing. Frames
+ * whose snapshot did not change are skipped but still paced. Frame work times go
+ * into a fixed histogram (no allocation while running) from which the
+ * percentiles are read when the game exits. Heap allocations made while a
+ * frame works are counted too, a settled game should make none.
+ */
+class RenderPacer {
+public:
+    // Histogram resolution and range, slower frames land in the last bucket
+    static constexpr int BUCKET_US = 100;
+    static constexpr int BUCKETS = 1000;
+
+    explicit RenderPacer(int targetFps = 20);
+
+    void beginFrame();
+    void endFrame(bool frameDrawn);
+    void report(FILE* out) const;
+
+    int targetFps() const { return fps; }
+    long long drawnFrames() const { return drawn; }
+    long long skippedFrames() const { return skipped; }
+    long long droppedFrames() const { return dropped; }
+    long long heapAllocations() const { return frameAllocations; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int fps;
+    Clock::duration period;
+    Clock::time_point frameStart;
+    Clock::time_point nextFrame;
+    bool started = false;
+
+    long long drawn = 0;
+    long long skipped = 0;
+    long long dropped = 0;
+    // operator new calls during frame work, see HeapCounter.h
+    long long heapAtFrameStart = 0;
+    long long frameAllocations = 0;
+    long long allocatingFrames = 0;
+    long long lastAllocatingFrame = 0;
+    std::array<long long, BUCKETS + 1> histogram{};
+
+    double percentileMs(double fraction) const;
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "Catagotchi.h"
+
+/**
+ * @file RenderSnapshot.h
+ * @brief Immutable frames handed from the physics thread to the render loop
+ *
+ * After every step the physics thread copies everything the renderer needs
+ * into a RenderSnapshot and publishes it through a TripleBuffer. The render
+ * loop only ever reads the latest published frame, so it never touches Box2D
+ * and never waits for the physics thread.
+ */
+
+/**
+ * @brief Rolling averages of what the physics thread spends its time on
+ *
+ * Only filled while profiling is switched on (the perf overlay is shown),
+ * otherwise all zero. Times are in milliseconds.
+ */
+struct PhysicsPerf {
+    // b2Profile
+    float step = 0.0f;
+    float collide = 0.0f;
+    float solve = 0.0f;
+    float sensors = 0.0f;
+    float sleepIslands = 0.0f;
+    // b2Counters
+    float bodies = 0.0f;
+    float contacts = 0.0f;
+    float awakeIslands = 0.0f;
+    float tasks = 0.0f;
+    // Time from a key press until its command was applied
+    float inputMs = 0.0f;
+};
+
+/**
+ * @brief What the render loop can show, handed to the physics thread
+ *
+ * cols/rows of 0 means unknown yet: everything is put into the snapshot.
+ */
+struct Viewport {
+    int cols = 0;
+    int rows = 0;
+    int selectedCat = 0;   // camera follows this cat, wraps around the colony
+};
+
+struct RenderSnapshot {
+    long long stepIndex = 0;
+    // Bumped by the physics thread whenever the picture may differ from the
+    // last snapshot, the render loop skips frames whose version it drew
+    long long contentVersion = 0;
+    PhysicsPerf perf;
+    // World cell shown in the top left corner of the terminal. It is
+    // negative where the world is smaller than the terminal, to center it.
+    float cameraX = 0.0f;
+    float cameraY = 0.0f;
+    float worldWidth = 0.0f;
+    float worldHeight = 0.0f;
+    int poopCount = 0;   // in the whole world, visible or not
+    // Only what is inside the camera's view
+    // The vectors keep their capacity between frames
+    std::vector<CatView> cats;
+    std::vector<FoodView> foods;
+    std::vector<PoopView> poops;
+};
+
+/**
+ * @brief Lock-free single producer / single consumer triple buffer
+ *
+ * The writer fills writeBuffer() and calls publish(); the reader calls
+ * update() and then reads readBuffer(). Neither side ever blocks and the
+ * reader always sees the most recently published complete value.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    /** @brief Buffer the producer may fill */
+    T& writeBuffer() { return buffers[back]; }
+
+    /** @brief Hand the filled write buffer over to the reader */
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | DIRTY), std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * @brief Grab the newest published buffer, if any
+     * @return True if readBuffer() changed
+     */
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & DIRTY) == 0) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /** @brief Buffer the consumer may read */
+    const T& readBuffer() const { return buffers[front]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    T buffers[3]{};
+    uint8_t back = 0;                  // owned by the writer
+    std::atomic<uint8_t> middle{ 1 };  // shared, index + dirty bit
+    uint8_t front = 2;                 // owned by the reader
+};
@@ -0,0 +1,271 @@
+#include "Renderer.h"
+#include <curses.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/**
+ * @file Renderer.cpp
+ * @brief Implementation of the Renderer
+ */
+
+namespace {
+    const char* COMMANDS = "Commands: q=quit  f=feed  p=perf";
+    const char* COMMANDS_CLEAN = "Commands: q=quit  f=feed  c=clean poop  p=perf";
+}
+
+ /**
+  * @brief Constructs a renderer, nothing is drawn before the first frame
+  *
+  * Builds the sprite atlas, so it must be created after initscr().
+  * @param titleLines ASCII title drawn at the top
+  * @param titleHeight Number of title lines
+  * @param titleWidth Width of the title, it is centered in the terminal
+  */
+Renderer::Renderer(const char** titleLines, int titleHeight, int titleWidth)
+    : title(titleLines), titleHeight(titleHeight), titleWidth(titleWidth) {
+    atlas.build();
+}
+
+/**
+ * @brief Draw a snapshot frame, touching only cells that changed
+ * @param frame Latest frame from the physics thread
+ */
+void Renderer::draw(const RenderSnapshot& frame) {
+    int rows = 0, cols = 0;
+    getmaxyx(stdscr, rows, cols);
+    bool changed = false;
+    if (dirty || rows != termRows || cols != termCols) {
+        termRows = rows;
+        termCols = cols;
+        layout();
+        changed = true;
+    }
+
+    // The ground moves with the camera, repaint the background under it
+    int col = (int)frame.cameraX, row = (int)frame.cameraY;
+    int wcols = (int)frame.worldWidth, wrows = (int)frame.worldHeight;
+    if (col != cameraCol || row != cameraRow || wcols != worldCols || wrows != worldRows) {
+        cameraCol = col;
+        cameraRow = row;
+        worldCols = wcols;
+        worldRows = wrows;
+        for (int r = 0; r < termRows; ++r)
+            paintRow(r);
+        changed = true;
+    }
+
+    bool clean = frame.poopCount > 0;
+    if (clean != cleanCommand) {
+        drawCommandBar(clean);
+        changed = true;
+    }
+
+    // Draw foodz, poopz and the cats
+    frameStep = frame.stepIndex;
+    for (const PoopView& poop : frame.poops)
+        Poop::draw(poop, *this);
+    for (const FoodView& food : frame.foods)
+        Food::draw(food, *this);
+    for (const CatView& cat : frame.cats)
+        Cat::draw(cat, *this);
+
+    if (flush() || changed) refresh();
+}
+
+/**
+ * @brief Put a sprite into the next frame's sprite layer
+ * @param x World x-position of the sprite's first character
+ * @param y World y-position of the sprite
+ * @param id Sprite to draw, animated sprites show the frame for this snapshot
+ *
+ * World positions become terminal cells through the camera here, and
+ * everything off screen or on the command bar is clipped here.
+ */
+void Renderer::plot(float x, float y, SpriteId id) {
+    int row = (int)floorf(y) - cameraRow;
+    if (row < 0 || row >= termRows - 1) return;
+    const Sprite& sprite = atlas.frame(id, frameStep);
+    int col = (int)floorf(x) - cameraCol;
+    int first = std::max(0, -col);
+    int last = std::min(sprite.width, termCols - col);
+    for (int i = first; i < last; ++i) {
+        // Overlapping sprites: the last one wins and the cell is listed once,
+        // so nextCells never outgrows the screen it was reserved for
+        int cell = row * termCols + col + i;
+        if (next[cell] == 0) nextCells.push_back(cell);
+        next[cell] = sprite.cells[i];
+    }
+}
+
+/**
+ * @brief Repaint the whole screen on the next frame
+ */
+void Renderer::invalidate() {
+    dirty = true;
+}
+
+/**
+ * @brief Rebuild the layers for the current terminal size and repaint everything
+ */
+void Renderer::layout() {
+    const size_t cells = (size_t)termRows * termCols;
+    xOffset = (termCols - titleWidth) / 2;
+    background.assign(cells, ' ');
+    onScreen.assign(cells, 0);
+    next.assign(cells, 0);
+    shownCells.clear();
+    nextCells.clear();
+    // Room for a screen full of sprites, so scrolling into crowds does not
+    // allocate: each cell is listed at most once per layer (see plot())
+    shownCells.reserve(cells);
+    nextCells.reserve(cells);
+    changedCells.reserve(2 * cells);
+
+    clear();
+    for (int r = 0; r < termRows; ++r)
+        paintRow(r);
+    dirty = false;
+}
+
+/**
+ * @brief Rebuild one row of the background layer and draw it
+ * @param row Terminal row
+ *
+ * The row gets the ground, the title, the command bar and the overlay,
+ * whichever cover it, with the sprites on it still on top.
+ */
+void Renderer::paintRow(int row) {
+    if (row < 0 || row >= termRows) return;
+    SpriteCell* cells = &background[(size_t)row * termCols];
+    std::fill(cells, cells + termCols, (SpriteCell)' ');
+
+    // The ground's top is two rows above the world's bottom, then the title
+    if (row == worldRows - 2 - cameraRow) {
+        int first = std::max(0, -cameraCol);
+        int last = std::min(termCols, worldCols - cameraCol);
+        for (int c = first; c < last; ++c)
+            cells[c] = '-';
+    }
+    if (row < titleHeight)
+        putText(row, xOffset, title[row]);
+    if (row == termRows - 1)
+        putText(row, xOffset, cleanCommand ? COMMANDS_CLEAN : COMMANDS);
+    if (row < (int)overlay.size())
+        putText(row, 0, overlay[row].c_str(), A_REVERSE);
+
+    blit(row, 0, termCols);
+}
+
+/**
+ * @brief Show text lines over the top left corner of the screen
+ * @param lines Lines to show, they are copied
+ * @param count Number of lines, 0 hides the overlay
+ *
+ * Only rows whose text changed are redrawn. The copies keep their storage,
+ * so updating lines of the same length does not allocate.
+ */
+void Renderer::setOverlay(const char* const* lines, int count) {
+    size_t rows = std::max((size_t)count, overlay.size());
+    bool changed = false;
+    overlay.resize(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        const char* text = (int)r < count ? lines[r] : "";
+        if (overlay[r] == text) continue;
+        overlay[r] = text;
+        if (!dirty) paintRow((int)r);
+        changed = true;
+    }
+    while (!overlay.empty() && overlay.back().empty()) overlay.pop_back();
+    if (changed && !dirty) refresh();
+}
+
+/**
+ * @brief Write text into the background layer, clipped to the terminal
+ * @param row Terminal row
+ * @param col Terminal column of the first character
+ * @param text Characters to write
+ * @param attributes Curses attributes for every character
+ */
+void Renderer::putText(int row, int col, const char* text, SpriteCell attributes) {
+    if (row < 0 || row >= termRows) return;
+    for (const char* c = text; *c; ++c, ++col)
+        if (col >= 0 && col < termCols)
+            background[(size_t)row * termCols + col] = (SpriteCell)(unsigned char)*c | attributes;
+}
+
+/**
+ * @brief Send a run of cells to curses, sprites on top of the background
+ * @param row Terminal row
+ * @param col First column
+ * @param count Number of cells, must stay within the row
+ */
+void Renderer::blit(int row, int col, int count) {
+    chtype run[256];
+    const size_t base = (size_t)row * termCols;
+    while (count > 0) {
+        int n = std::min(count, (int)(sizeof run / sizeof run[0]));
+        for (int i = 0; i < n; ++i) {
+            size_t cell = base + col + i;
+            run[i] = (chtype)(onScreen[cell] ? onScreen[cell] : background[cell]);
+        }
+        mvaddchnstr(row, col, run, n);
+        col += n;
+        count -= n;
+    }
+}
+
+/**
+ * @brief Draw the command bar in the bottom of the screen
+ * @param clean True if there is poop to clean
+ */
+void Renderer::drawCommandBar(bool clean) {
+    cleanCommand = clean;
+    paintRow(termRows - 1);
+}
+
+/**
+ * @brief Send the difference between the sprite layers to curses
+ * @return True if any cell was written
+ *
+ * Changed cells are sorted and sent as runs along each row. Runs separated
+ * by a couple of unchanged cells are merged, curses skips those anyway.
+ */
+bool Renderer::flush() {
+    changedCells.clear();
+
+    // Cells a sprite left get their background back
+    for (int cell : shownCells) {
+        if (next[cell] == 0 && onScreen[cell] != 0) {
+            onScreen[cell] = 0;
+            changedCells.push_back(cell);
+        }
+    }
+    // Cells with a new or different sprite
+    for (int cell : nextCells) {
+        if (next[cell] != onScreen[cell]) {
+            onScreen[cell] = next[cell];
+            changedCells.push_back(cell);
+        }
+    }
+    for (int cell : nextCells)
+        next[cell] = 0;
+
+    std::swap(shownCells, nextCells);
+    nextCells.clear();
+    if (changedCells.empty()) return false;
+
+    std::sort(changedCells.begin(), changedCells.end());
+    const int MAX_GAP = 2;
+    size_t i = 0;
+    while (i < changedCells.size()) {
+        int start = changedCells[i];
+        int row = start / termCols;
+        int rowEnd = (row + 1) * termCols;
+        int end = start + 1;
+        while (++i < changedCells.size() && changedCells[i] < rowEnd && changedCells[i] - end <= MAX_GAP)
+            end = changedCells[i] + 1;
+        blit(row, start % termCols, end - start);
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "RenderSnapshot.h"
+#include "SpriteAtlas.h"
+
+/**
+ * @file Renderer.h
+ * @brief Retained-mode curses renderer that only redraws what changed
+ *
+ * The title, the ground and the command bar are kept in a background layer
+ * that is painted once (and again after the terminal is resized or the
+ * camera moved). The title and the command bar stay put, the ground and
+ * the sprites scroll with the camera of each snapshot. Sprites are
+ * plotted into a sprite layer every frame which is compared with the one on
+ * screen: cells a sprite left get their background back, cells whose sprite
+ * changed are drawn, everything else is not touched. An idle cat therefore
+ * costs no terminal output at all.
+ *
+ * All layers hold curses cells (character plus attributes). Sprites come
+ * ready-made from the SpriteAtlas, and changed cells go to curses in runs
+ * with mvaddchnstr. plot() is the one place that clips to the screen.
+ */
+class Renderer {
+public:
+    Renderer(const char** titleLines, int titleHeight, int titleWidth);
+
+    void draw(const RenderSnapshot& frame);
+    void plot(float x, float y, SpriteId id);
+    void invalidate();
+    void setOverlay(const char* const* lines, int count);
+
+    int rows() const { return termRows; }
+    int cols() const { return termCols; }
+
+private:
+    const char** title;
+    int titleHeight;
+    int titleWidth;
+    SpriteAtlas atlas;
+    long long frameStep = 0;   // physics step of the frame being drawn, picks animation frames
+
+    int termRows = 0;
+    int termCols = 0;
+    int xOffset = 0;        // of the title and the command bar
+    int cameraCol = 0;      // world cell in the top left corner
+    int cameraRow = 0;
+    int worldCols = 0;
+    int worldRows = 0;
+    bool dirty = true;
+    bool cleanCommand = false;
+
+    // One cell per terminal cell, 0 in the sprite layers means no sprite
+    std::vector<SpriteCell> background;
+    std::vector<SpriteCell> onScreen;
+    std::vector<SpriteCell> next;
+    // Cells holding a sprite in onScreen / next
+    std::vector<int> shownCells;
+    std::vector<int> nextCells;
+    // Cells written by the current flush()
+    std::vector<int> changedCells;
+    // Text drawn over the top left corner, one entry per row
+    std::vector<std::string> overlay;
+
+    void layout();
+    void paintRow(int row);
+    void putText(int row, int col, const char* text, SpriteCell attributes = 0);
+    void blit(int row, int col, int count);
+    void drawCommandBar(bool clean);
+    bool flush();
+};
@@ -0,0 +1,134 @@
+#include "SessionLog.h"
+#include <cstring>
+
+/**
+ * @file SessionLog.cpp
+ * @brief Implementation of the session recorder and reader
+ */
+
+namespace {
+    const uint8_t STEP_TAG = 0x00;
+    const uint8_t COMMAND_TAG = 0x80;
+}
+
+/**
+ * @brief Closes the file if it is still open
+ */
+SessionRecorder::~SessionRecorder() {
+    close();
+}
+
+/**
+ * @brief Create the session file and write its header
+ * @param path File to (over)write
+ * @param header World setup and RNG seed of the session
+ * @return False if the file could not be created
+ */
+bool SessionRecorder::open(const char* path, const SessionHeader& header) {
+    close();
+    file = fopen(path, "wb");
+    if (!file) return false;
+    fwrite(&header, sizeof(header), 1, file);
+    step = 0;
+    lastCommandStep = 0;
+    return true;
+}
+
+/**
+ * @brief Flush and close the file
+ */
+void SessionRecorder::close() {
+    if (!file) return;
+    fclose(file);
+    file = nullptr;
+}
+
+/**
+ * @brief Record a command applied in the current step
+ * @param command Command that was just applied
+ */
+void SessionRecorder::command(const Command& command) {
+    if (!file) return;
+    uint8_t bytes[16];
+    int count = 0;
+    bytes[count++] = COMMAND_TAG | (uint8_t)command.type;
+    unsigned long long delta = (unsigned long long)(step - lastCommandStep);
+    do {
+        uint8_t b = delta & 0x7f;
+        delta >>= 7;
+        bytes[count++] = delta ? (b | 0x80) : b;
+    } while (delta);
+    fwrite(bytes, 1, count, file);
+    lastCommandStep = step;
+}
+
+/**
+ * @brief Record the end of a step
+ * @param worldHash GameWorld::hash() after the step
+ */
+void SessionRecorder::endStep(uint32_t worldHash) {
+    if (!file) return;
+    uint8_t bytes[5] = { STEP_TAG, (uint8_t)worldHash, (uint8_t)(worldHash >> 8),
+        (uint8_t)(worldHash >> 16), (uint8_t)(worldHash >> 24) };
+    fwrite(bytes, 1, sizeof(bytes), file);
+    step++;
+}
+
+/**
+ * @brief Closes the file if it is still open
+ */
+SessionReader::~SessionReader() {
+    if (file) fclose(file);
+}
+
+/**
+ * @brief Open a session file and read its header
+ * @param path File written by SessionRecorder
+ * @param header Receives the world setup and seed
+ * @return False if the file is missing or not a session of this version
+ */
+bool SessionReader::open(const char* path, SessionHeader& header) {
+    file = fopen(path, "rb");
+    if (!file) return false;
+    SessionHeader expected;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version) {
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+    currentStep = 0;
+    lastCommandStep = 0;
+    return true;
+}
+
+/**
+ * @brief Read the next record
+ * @return What was read, see the accessors for its contents
+ */
+SessionReader::Record SessionReader::next() {
+    int tag = fgetc(file);
+    if (tag == EOF) return Record::End;
+
+    if (tag == STEP_TAG) {
+        uint8_t bytes[4];
+        if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return Record::Corrupt;
+        stepHash = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        currentStep++;
+        return Record::Step;
+    }
+
+    if ((tag & COMMAND_TAG) == 0) return Record::Corrupt;
+    type = (CommandType)(tag & ~COMMAND_TAG);
+    unsigned long long delta = 0;
+    for (int shift = 0; ; shift += 7) {
+        int b = fgetc(file);
+        if (b == EOF || shift > 56) return Record::Corrupt;
+        delta |= (unsigned long long)(b & 0x7f) << shift;
+        if (!(b & 0x80)) break;
+    }
+    lastCommandStep += (long long)delta;
+    if (lastCommandStep != currentStep) return Record::Corrupt;
+    return Record::Command;
+}
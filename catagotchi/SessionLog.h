@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "CommandQueue.h"
+
+/**
+ * @file SessionLog.h
+ * @brief Compact binary recording of a game session for deterministic replay
+ *
+ * The world only changes through commands applied at the start of a physics
+ * step and through the seeded food RNG, so a session is fully described by
+ * the world setup, the seed and which command was applied at which step.
+ *
+ * File layout: a SessionHeader followed by records, each starting with a tag
+ * byte.
+ * - Command: 0x80 | CommandType, then the number of steps since the previous
+ *   command as a LEB128 varint (usually one byte).
+ * - Step: 0x00, then the 32-bit world hash after the step (little endian).
+ *
+ * An idle session therefore costs 5 bytes per step, the hash that lets the
+ * replayer check every single step.
+ */
+
+struct SessionHeader {
+    char magic[4] = { 'C', 'A', 'T', 'S' };
+    uint32_t version = 1;
+    uint32_t seed = 0;
+    float worldWidth = 0.0f;
+    float worldHeight = 0.0f;
+    int32_t spawnHeight = 0;
+    int32_t cats = 0;
+};
+
+/**
+ * @brief Writes a session, only called from the thread that steps the world
+ */
+class SessionRecorder {
+public:
+    SessionRecorder() = default;
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    bool open(const char* path, const SessionHeader& header);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void command(const Command& command);
+    void endStep(uint32_t worldHash);
+
+    long long steps() const { return step; }
+
+private:
+    FILE* file = nullptr;
+    long long step = 0;
+    long long lastCommandStep = 0;
+};
+
+/**
+ * @brief Reads a session written by SessionRecorder
+ */
+class SessionReader {
+public:
+    enum class Record {
+        Command,   // command() is valid, it belongs to step()
+        Step,      // step() ended, hash() is the recorded world hash
+        End,
+        Corrupt,
+    };
+
+    SessionReader() = default;
+    ~SessionReader();
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    bool open(const char* path, SessionHeader& header);
+    Record next();
+
+    CommandType command() const { return type; }
+    long long step() const { return currentStep; }
+    uint32_t hash() const { return stepHash; }
+
+private:
+    FILE* file = nullptr;
+    long long currentStep = 0;
+    long long lastCommandStep = 0;
+    CommandType type = CommandType::SpawnFood;
+    uint32_t stepHash = 0;
+};
@@ -0,0 +1,86 @@
+#include "SpriteAtlas.h"
+#include <curses.h>
+#include <cstring>
+
+/**
+ * @file SpriteAtlas.cpp
+ * @brief Implementation of the SpriteAtlas
+ */
+
+static_assert(sizeof(chtype) <= sizeof(SpriteCell), "SpriteCell must hold a chtype");
+
+namespace {
+
+    // Color pairs, used only if the terminal has colors
+    enum : short { PAIR_CAT = 1, PAIR_FOOD, PAIR_POOP };
+
+    struct AnimationDef {
+        SpriteId id;
+        const char* frames[SpriteAtlas::MAX_FRAMES];
+        int stepsPerFrame;   // physics steps each frame stays up, a multiple of ANIMATION_STEPS
+        short colorPair;
+        chtype attributes;
+    };
+
+    // The idle cat blinks, the hungry one chatters, the blocked one frowns
+    const AnimationDef ANIMATIONS[] = {
+        { SpriteId::CatIdle, { "=^.^=", "=^.^=", "=^.^=", "=-.-=" }, 30, PAIR_CAT, A_NORMAL },
+        { SpriteId::CatChasing, { "=^.^=", "=^o^=" }, 10, PAIR_CAT, A_BOLD },
+        { SpriteId::CatAvoiding, { "=>.<=" }, SpriteAtlas::ANIMATION_STEPS, PAIR_CAT, A_BOLD },
+        { SpriteId::Food, { "*" }, SpriteAtlas::ANIMATION_STEPS, PAIR_FOOD, A_BOLD },
+        { SpriteId::Poop, { "o" }, SpriteAtlas::ANIMATION_STEPS, PAIR_POOP, A_NORMAL },
+    };
+
+}
+
+/**
+ * @brief Convert every sprite frame into cells
+ *
+ * Call after initscr(). Sets up the color pairs if the terminal has colors,
+ * otherwise only the attributes are used.
+ */
+void SpriteAtlas::build() {
+    bool colors = has_colors();
+    if (colors) {
+        // -1 keeps the terminal's own background
+        start_color();
+        use_default_colors();
+        init_pair(PAIR_CAT, COLOR_WHITE, -1);
+        init_pair(PAIR_FOOD, COLOR_YELLOW, -1);
+        init_pair(PAIR_POOP, COLOR_RED, -1);
+    }
+
+    // Size the storage first, the sprites point into it
+    size_t total = 0;
+    for (const AnimationDef& def : ANIMATIONS)
+        for (const char* text : def.frames)
+            if (text) total += strlen(text);
+    cells.assign(total, 0);
+
+    size_t next = 0;
+    for (const AnimationDef& def : ANIMATIONS) {
+        Animation& animation = animations[(size_t)def.id];
+        chtype attributes = def.attributes | (colors ? COLOR_PAIR(def.colorPair) : 0);
+        animation.frameCount = 0;
+        animation.stepsPerFrame = def.stepsPerFrame;
+        for (const char* text : def.frames) {
+            if (!text) break;
+            Sprite& sprite = animation.frames[animation.frameCount++];
+            sprite.cells = &cells[next];
+            sprite.width = (int)strlen(text);
+            for (const char* c = text; *c; ++c)
+                cells[next++] = (SpriteCell)((chtype)(unsigned char)*c | attributes);
+        }
+    }
+}
+
+/**
+ * @brief The frame of an animation to show at a given time
+ * @param id Which sprite
+ * @param step Physics step of the frame being drawn
+ */
+const Sprite& SpriteAtlas::frame(SpriteId id, long long step) const {
+    const Animation& animation = animations[(size_t)id];
+    if (animation.frameCount <= 1) return animation.frames[0];
+    return animation.frames[(step / animation.stepsPerFrame) % animation.frameCount];
+}
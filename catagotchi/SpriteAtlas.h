@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file SpriteAtlas.h
+ * @brief Sprites and their animation frames as ready-to-blit curses cells
+ *
+ * Every sprite frame is converted once, at startup, into an array of cells
+ * holding the character together with its attributes and color pair (a
+ * curses chtype). Drawing a sprite is then a copy of that array into the
+ * Renderer's sprite layer, and the Renderer sends runs of changed cells to
+ * curses with mvaddchnstr: no printf formatting and no per-character
+ * attribute calls.
+ *
+ * curses.h stays out of this header (its macros clash with the standard
+ * library), so cells are stored as SpriteCell, which holds a chtype.
+ */
+
+using SpriteCell = uint32_t;
+
+enum class SpriteId : uint8_t {
+    CatIdle,
+    CatChasing,
+    CatAvoiding,
+    Food,
+    Poop,
+    Count
+};
+
+/**
+ * @brief One frame: width cells starting at cells
+ */
+struct Sprite {
+    const SpriteCell* cells = nullptr;
+    int width = 0;
+};
+
+class SpriteAtlas {
+public:
+    static constexpr int MAX_FRAMES = 4;
+    // Animations only change frame on multiples of this many physics steps
+    static constexpr int ANIMATION_STEPS = 10;
+    static constexpr size_t SPRITE_COUNT = static_cast<size_t>(SpriteId::Count);
+
+    void build();
+    const Sprite& frame(SpriteId id, long long step) const;
+
+private:
+    struct Animation {
+        Sprite frames[MAX_FRAMES];
+        int frameCount = 0;
+        int stepsPerFrame = 1;
+    };
+
+    std::array<Animation, SPRITE_COUNT> animations{};
+    std::vector<SpriteCell> cells;   // every frame's cells, back to back
+};
@@ -0,0 +1,80 @@
+#include "StaticGeometry.h"
+
+/**
+ * @file StaticGeometry.cpp
+ * @brief Implementation of the StaticGeometry builder
+ */
+
+ /**
+  * @brief Create the terrain and poop pile bodies
+  * @param world Box2D world the shapes live in
+  */
+void StaticGeometry::create(b2WorldId world) {
+    worldId = world;
+    b2BodyDef bd = b2DefaultBodyDef();
+    bd.type = b2_staticBody;
+    terrainId = b2CreateBody(worldId, &bd);
+    pilesId = b2CreateBody(worldId, &bd);
+    pending = 0;
+}
+
+/**
+ * @brief Forget the bodies without touching Box2D (used when the world is destroyed)
+ */
+void StaticGeometry::clear() {
+    terrainId = b2_nullBodyId;
+    pilesId = b2_nullBodyId;
+    pending = 0;
+}
+
+/**
+ * @brief Add a solid box to the terrain, for ground segments and obstacles
+ * @param centerX X-position of the box's center
+ * @param centerY Y-position of the box's center
+ * @param halfWidth Half of the box's width
+ * @param halfHeight Half of the box's height
+ * @param friction Friction of the box's surface
+ * @return The new shape
+ */
+b2ShapeId StaticGeometry::addBox(float centerX, float centerY, float halfWidth, float halfHeight, float friction) {
+    b2Polygon box = b2MakeOffsetBox(halfWidth, halfHeight, { centerX, centerY }, b2Rot_identity);
+    b2ShapeDef sd = b2DefaultShapeDef();
+    sd.material.friction = friction;
+    pending++;
+    return b2CreatePolygonShape(terrainId, &sd, &box);
+}
+
+/**
+ * @brief Add a poop pile
+ * @param x X-position of the pile
+ * @param y Y-position of the pile
+ * @return The new shape
+ */
+b2ShapeId StaticGeometry::addPoop(float x, float y) {
+    b2Polygon box = b2MakeOffsetBox(0.5f, 0.5f, { x, y }, b2Rot_identity);
+    b2ShapeDef sd = b2DefaultShapeDef();
+    sd.filter.categoryBits = POOP_CATEGORY;
+    sd.filter.maskBits = POOP_CATEGORY;   // static shapes never pair with each other
+    sd.enableSensorEvents = false;
+    pending++;
+    return b2CreatePolygonShape(pilesId, &sd, &box);
+}
+
+/**
+ * @brief Remove a terrain box or poop pile
+ * @param shapeId Shape returned by addBox() or addPoop()
+ */
+void StaticGeometry::remove(b2ShapeId shapeId) {
+    b2DestroyShape(shapeId, false);
+    pending++;
+}
+
+/**
+ * @brief Finish a batch: rebuild the static tree once if anything changed
+ */
+void StaticGeometry::commit() {
+    if (pending == 0) return;
+    b2World_RebuildStaticTree(worldId);
+    pending = 0;
+    rebuilds++;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <box2d/box2d.h>
+
+/**
+ * @file StaticGeometry.h
+ * @brief Batched static shapes: terrain, obstacles and poop piles
+ *
+ * A static body per feature puts a body, a solver set entry and a proxy into
+ * the world for every poop, and each new proxy is inserted into the static
+ * tree one by one, which leaves the tree lopsided as the colony fills up.
+ * Here all features are shapes on two static bodies, one for the terrain and
+ * one for the poop piles. Changes are batched and commit() rebuilds the
+ * static tree once per batch.
+ */
+class StaticGeometry {
+public:
+    void create(b2WorldId worldId);
+    void clear();
+
+    b2ShapeId addBox(float centerX, float centerY, float halfWidth, float halfHeight, float friction);
+    b2ShapeId addPoop(float x, float y);
+    void remove(b2ShapeId shapeId);
+    void commit();
+
+    int pendingChanges() const { return pending; }
+    int rebuildCount() const { return rebuilds; }
+
+    // Collision category of poop shapes. Poops only accept their own
+    // category, so they never touch cats or food but queries can find them.
+    static constexpr uint64_t POOP_CATEGORY = 0x0008;
+
+private:
+    b2WorldId worldId{};
+    b2BodyId terrainId{};
+    b2BodyId pilesId{};
+
+    int pending = 0;    // shapes added or removed since the last commit
+    int rebuilds = 0;
+};
@@ -0,0 +1,231 @@
+#include "TaskScheduler.h"
+#include "Trace.h"
+#include <algorithm>
+
+/**
+ * @file TaskScheduler.cpp
+ * @brief Implementation of the work-stealing task scheduler
+ */
+
+namespace {
+
+    /**
+     * @brief Scoped acquire of a worker deque's spin lock
+     */
+    struct SpinGuard {
+        std::atomic_flag& flag;
+        explicit SpinGuard(std::atomic_flag& f) : flag(f) {
+            while (flag.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        ~SpinGuard() { flag.clear(std::memory_order_release); }
+    };
+
+}
+
+/**
+ * @brief Add an entry to the back of the deque
+ * @return False if the deque is full
+ */
+bool TaskScheduler::Worker::push(Task* task) {
+    SpinGuard guard(lock);
+    if (back - front == QUEUE_CAPACITY) return false;
+    entries[back++ & (QUEUE_CAPACITY - 1)] = task;
+    return true;
+}
+
+/**
+ * @brief Take the newest entry, used by the owning worker
+ */
+TaskScheduler::Task* TaskScheduler::Worker::popBack() {
+    SpinGuard guard(lock);
+    if (back == front) return nullptr;
+    return entries[--back & (QUEUE_CAPACITY - 1)];
+}
+
+/**
+ * @brief Take the oldest entry, used by thieves
+ */
+TaskScheduler::Task* TaskScheduler::Worker::popFront() {
+    SpinGuard guard(lock);
+    if (back == front) return nullptr;
+    return entries[front++ & (QUEUE_CAPACITY - 1)];
+}
+
+/**
+ * @brief Starts workerCount - 1 worker threads
+ */
+TaskScheduler::TaskScheduler(int workerCount) {
+    workerCount = std::max(1, std::min(workerCount, MAX_WORKERS));
+    for (int i = 1; i < workerCount; ++i)
+        workers.push_back(new Worker());
+    for (int i = 0; i < (int)workers.size(); ++i)
+        workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+}
+
+/**
+ * @brief Stops and joins the worker threads
+ *
+ * Every world using this scheduler must be destroyed first.
+ */
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMu);
+        shutdown = true;
+    }
+    sleepCv.notify_all();
+    for (Worker* worker : workers) {
+        worker->thread.join();
+        delete worker;
+    }
+}
+
+/**
+ * @brief Fill in the task fields of a world definition
+ * @param def World definition passed to b2CreateWorld afterwards
+ */
+void TaskScheduler::configure(b2WorldDef& def) {
+    def.workerCount = workerCount();
+    def.enqueueTask = &TaskScheduler::enqueueTask;
+    def.finishTask = &TaskScheduler::finishTask;
+    def.userTaskContext = this;
+}
+
+/**
+ * @brief Claim and run the next chunk of a task
+ * @param task Task to help with
+ * @param threadIndex Box2D worker index of the calling thread
+ * @return False if all chunks were already claimed
+ */
+bool TaskScheduler::runChunk(Task* task, uint32_t threadIndex) {
+    int chunk = task->nextChunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= task->chunkCount) return false;
+
+    int start = (int)((long long)task->itemCount * chunk / task->chunkCount);
+    int end = (int)((long long)task->itemCount * (chunk + 1) / task->chunkCount);
+    {
+        TraceScope trace("box2d task");
+        task->callback(start, end, threadIndex, task->context);
+    }
+    task->doneChunks.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Pop from the worker's own deque or steal from another one
+ * @param index Index into workers
+ */
+TaskScheduler::Task* TaskScheduler::findWork(int index) {
+    if (Task* task = workers[index]->popBack()) return task;
+
+    int count = (int)workers.size();
+    for (int i = 1; i < count; ++i) {
+        if (Task* task = workers[(index + i) % count]->popFront()) return task;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Worker thread body
+ * @param index Index into workers, the Box2D worker index is index + 1
+ *
+ * Runs queued entries until none are left, spins for a short while in case
+ * the next stage of the step follows right away, and then sleeps.
+ */
+void TaskScheduler::workerLoop(int index) {
+    const uint32_t threadIndex = (uint32_t)index + 1;
+    int idleSpins = 0;
+    traceThread("box2d worker");
+
+    while (!shutdown.load(std::memory_order_relaxed)) {
+        if (Task* task = findWork(index)) {
+            queuedEntries.fetch_sub(1, std::memory_order_relaxed);
+            runChunk(task, threadIndex);
+            task->refs.fetch_sub(1, std::memory_order_release);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < 2000) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMu);
+        sleepCv.wait(lock, [this] { return shutdown.load() || queuedEntries.load() > 0; });
+        idleSpins = 0;
+    }
+}
+
+/**
+ * @brief b2EnqueueTaskCallback: split a Box2D task into chunks and queue them
+ * @return The task slot, or nullptr if the task was run inline
+ */
+void* TaskScheduler::enqueueTask(b2TaskCallback* callback, int itemCount, int minRange,
+    void* taskContext, void* userContext) {
+    TaskScheduler* self = static_cast<TaskScheduler*>(userContext);
+    int workerCount = self->workerCount();
+
+    // Find a free task slot, run inline if every slot is busy
+    Task* task = nullptr;
+    for (int i = 0; i < MAX_TASKS && task == nullptr; ++i) {
+        Task* candidate = self->tasks + (self->nextTask + i) % MAX_TASKS;
+        if (candidate->refs.load(std::memory_order_acquire) == 0) {
+            task = candidate;
+            self->nextTask = (self->nextTask + i + 1) % MAX_TASKS;
+        }
+    }
+    if (workerCount == 1 || task == nullptr) {
+        callback(0, itemCount, 0, taskContext);
+        return nullptr;
+    }
+
+    // Every chunk must hold at least minRange items
+    int chunkCount = std::max(1, itemCount / std::max(1, minRange));
+    chunkCount = std::min(chunkCount, workerCount * CHUNKS_PER_WORKER);
+
+    task->callback = callback;
+    task->context = taskContext;
+    task->itemCount = itemCount;
+    task->chunkCount = chunkCount;
+    task->nextChunk.store(0, std::memory_order_relaxed);
+    task->doneChunks.store(0, std::memory_order_relaxed);
+    task->refs.store(1, std::memory_order_relaxed);
+
+    int queued = 0;
+    int queueCount = (int)self->workers.size();
+    for (int i = 0; i < chunkCount; ++i) {
+        task->refs.fetch_add(1, std::memory_order_relaxed);
+        if (self->workers[self->nextQueue++ % queueCount]->push(task)) {
+            queued++;
+        }
+        else {
+            // Full deque: the caller picks this chunk up in finishTask
+            task->refs.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    self->queuedEntries.fetch_add(queued, std::memory_order_release);
+    {
+        // Taking the lock orders this with a worker that is about to sleep
+        std::lock_guard<std::mutex> lock(self->sleepMu);
+    }
+    self->sleepCv.notify_all();
+    return task;
+}
+
+/**
+ * @brief b2FinishTaskCallback: help run the task and wait until it is done
+ */
+void TaskScheduler::finishTask(void* userTask, void* userContext) {
+    TaskScheduler* self = static_cast<TaskScheduler*>(userContext);
+    Task* task = static_cast<Task*>(userTask);
+
+    // The stepping thread is Box2D worker 0
+    while (self->runChunk(task, 0)) {
+    }
+    while (task->doneChunks.load(std::memory_order_acquire) < task->chunkCount)
+        std::this_thread::yield();
+
+    task->refs.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <box2d/box2d.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file TaskScheduler.h
+ * @brief Work-stealing thread pool that runs Box2D's parallel stages
+ *
+ * Box2D splits collision, solving, sensor and tree updates into tasks and
+ * hands them to the application through b2WorldDef::enqueueTask/finishTask.
+ * Without a pool they all run serially on the stepping thread. This is the
+ * in-app equivalent of what the Box2D benchmark does with enkiTS.
+ *
+ * A task is split into chunks. Every chunk gets an entry in one of the
+ * worker deques; a worker takes entries from the back of its own deque and
+ * steals from the front of the others when it runs dry. The thread that
+ * calls finishTask() helps by running chunks of that task itself.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @param workerCount Total workers including the stepping thread, so
+     *        workerCount - 1 threads are started. 1 means serial.
+     */
+    explicit TaskScheduler(int workerCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int workerCount() const { return (int)workers.size() + 1; }
+
+    /** @brief Point the Box2D task callbacks of a world definition at this pool */
+    void configure(b2WorldDef& def);
+
+    static constexpr int MAX_WORKERS = 64;   // B2_MAX_WORKERS, Box2D ignores more
+
+private:
+    static constexpr int MAX_TASKS = 256;
+    static constexpr int QUEUE_CAPACITY = 1024;   // power of two
+    static constexpr int CHUNKS_PER_WORKER = 4;
+
+    struct Task {
+        b2TaskCallback* callback = nullptr;
+        void* context = nullptr;
+        int itemCount = 0;
+        int chunkCount = 0;
+        std::atomic<int> nextChunk{ 0 };
+        std::atomic<int> doneChunks{ 0 };
+        std::atomic<int> refs{ 0 };   // queued entries + the caller; free when 0
+    };
+
+    /** @brief A worker's deque of task entries, guarded by a spin lock */
+    struct Worker {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        Task* entries[QUEUE_CAPACITY];
+        unsigned front = 0;
+        unsigned back = 0;
+        std::thread thread;
+
+        bool push(Task* task);
+        Task* popBack();
+        Task* popFront();
+    };
+
+    std::vector<Worker*> workers;
+    Task tasks[MAX_TASKS];
+    int nextTask = 0;
+    unsigned nextQueue = 0;
+
+    std::atomic<int> queuedEntries{ 0 };
+    std::atomic<bool> shutdown{ false };
+    std::mutex sleepMu;
+    std::condition_variable sleepCv;
+
+    void workerLoop(int index);
+    Task* findWork(int index);
+    bool runChunk(Task* task, uint32_t threadIndex);
+
+    static void* enqueueTask(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext);
+    static void finishTask(void* userTask, void* userContext);
+};
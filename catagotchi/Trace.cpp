@@ -0,0 +1,208 @@
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @file Trace.cpp
+ * @brief Implementation of the event tracer
+ */
+
+std::atomic<bool> traceOn{ false };
+
+namespace {
+
+    struct TraceEvent {
+        const char* name;
+        int64_t timestamp;   // steady clock nanoseconds
+        char phase;          // 'B' or 'E'
+    };
+
+    /**
+     * @brief One thread's ring of events
+     *
+     * written counts every event ever recorded, event i lives in
+     * events[i % TRACE_EVENTS_PER_THREAD].
+     */
+    struct TraceBuffer {
+        const char* threadName = nullptr;
+        int threadId = 0;
+        std::atomic<uint64_t> written{ 0 };
+        TraceEvent events[TRACE_EVENTS_PER_THREAD];
+    };
+
+    // Rings are never freed so a late traceWrite() still sees threads that ended
+    std::atomic<TraceBuffer*> buffers[TRACE_MAX_THREADS];
+    std::atomic<int> bufferCount{ 0 };
+
+    thread_local TraceBuffer* threadBuffer = nullptr;
+    thread_local const char* threadName = nullptr;
+    thread_local bool threadDropped = false;
+
+    /**
+     * @brief The calling thread's ring, created on first use
+     * @return nullptr if TRACE_MAX_THREADS threads are traced already
+     */
+    TraceBuffer* localBuffer() {
+        if (threadBuffer || threadDropped) return threadBuffer;
+        int index = bufferCount.load(std::memory_order_relaxed);
+        do {
+            if (index >= TRACE_MAX_THREADS) {
+                threadDropped = true;
+                return nullptr;
+            }
+        } while (!bufferCount.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+        // The slot is ours, publish the ring once it is fully set up
+        TraceBuffer* buffer = new TraceBuffer();
+        buffer->threadName = threadName;
+        buffer->threadId = index + 1;
+        buffers[index].store(buffer, std::memory_order_release);
+        threadBuffer = buffer;
+        return buffer;
+    }
+
+    /**
+     * @brief Append an event to the calling thread's ring
+     */
+    void record(const char* name, int64_t timestamp, char phase) {
+        TraceBuffer* buffer = localBuffer();
+        if (!buffer) return;
+        uint64_t index = buffer->written.load(std::memory_order_relaxed);
+        buffer->events[index & (TRACE_EVENTS_PER_THREAD - 1)] = { name, timestamp, phase };
+        buffer->written.store(index + 1, std::memory_order_release);
+    }
+
+}
+
+/**
+ * @brief Start or stop recording events
+ * @param enabled True to record from now on
+ */
+void traceEnable(bool enabled) {
+    traceOn.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Name the calling thread in the trace
+ * @param name String literal shown as the thread's track name
+ *
+ * Call at the start of the thread, before it records anything.
+ */
+void traceThread(const char* name) {
+    threadName = name;
+}
+
+/**
+ * @brief Record the start of a span on the calling thread
+ * @param name String literal, it is stored as a pointer
+ * @param timestamp From traceNow()
+ */
+void traceBegin(const char* name, int64_t timestamp) {
+    record(name, timestamp, 'B');
+}
+
+/**
+ * @brief Record the end of the span begun last on the calling thread
+ * @param name Same name as the matching traceBegin()
+ * @param timestamp From traceNow()
+ */
+void traceEnd(const char* name, int64_t timestamp) {
+    record(name, timestamp, 'E');
+}
+
+/**
+ * @brief Record a b2World_Step call with its b2Profile stages nested inside
+ * @param worldId World that was just stepped
+ * @param start traceNow() right before b2World_Step
+ * @param end traceNow() right after it
+ *
+ * Box2D only reports how long each stage took, so the stages are laid out
+ * one after the other in the order b2World_Step runs them: pair update,
+ * collide, solve (ending with sleep islands) and sensors.
+ */
+void traceWorldStep(b2WorldId worldId, int64_t start, int64_t end) {
+    if (!traceEnabled()) return;
+    b2Profile profile = b2World_GetProfile(worldId);
+    auto ns = [](float ms) { return (int64_t)(ms * 1e6f); };
+
+    traceBegin("b2World_Step", start);
+    int64_t t = start;
+    auto stage = [&t, end](const char* name, int64_t duration) {
+        int64_t stageEnd = t + duration < end ? t + duration : end;
+        traceBegin(name, t);
+        traceEnd(name, stageEnd);
+        t = stageEnd;
+    };
+    stage("pairs", ns(profile.pairs));
+    stage("collide", ns(profile.collide));
+
+    int64_t solveStart = t;
+    int64_t solveEnd = solveStart + ns(profile.solve) < end ? solveStart + ns(profile.solve) : end;
+    traceBegin("solve", solveStart);
+    int64_t sleep = ns(profile.sleepIslands);
+    if (sleep > 0 && sleep <= solveEnd - solveStart) {
+        traceBegin("sleepIslands", solveEnd - sleep);
+        traceEnd("sleepIslands", solveEnd);
+    }
+    traceEnd("solve", solveEnd);
+    t = solveEnd;
+
+    stage("sensors", ns(profile.sensors));
+    traceEnd("b2World_Step", end);
+}
+
+/**
+ * @brief Timestamp for traceBegin() / traceEnd()
+ * @return Steady clock nanoseconds, the same clock as CommandQueue::now()
+ */
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Write every thread's recorded events as Chrome trace JSON
+ * @param path File to write
+ * @return False if the file cannot be written
+ *
+ * Recording goes on while the file is written.
+ */
+bool traceWrite(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    std::vector<TraceEvent> events;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"catagotchi\"}}");
+
+    int count = bufferCount.load(std::memory_order_relaxed);
+    if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+    for (int i = 0; i < count; ++i) {
+        const TraceBuffer* buffer = buffers[i].load(std::memory_order_acquire);
+        if (!buffer) continue;   // still being set up
+
+        // Copy what is published, then drop what was overwritten meanwhile
+        uint64_t end = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_EVENTS_PER_THREAD ? end - TRACE_EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t e = begin; e < end; ++e)
+            events.push_back(buffer->events[e & (TRACE_EVENTS_PER_THREAD - 1)]);
+        uint64_t after = buffer->written.load(std::memory_order_acquire);
+        uint64_t valid = after > TRACE_EVENTS_PER_THREAD ? after - TRACE_EVENTS_PER_THREAD : 0;
+        size_t skip = valid > begin ? (size_t)(valid - begin) : 0;
+
+        const char* name = buffer->threadName ? buffer->threadName : "thread";
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            buffer->threadId, name);
+        for (size_t e = skip; e < events.size(); ++e) {
+            const TraceEvent& event = events[e];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                event.name, event.phase, event.timestamp / 1000.0, buffer->threadId);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    bool ok = fflush(file) == 0 && !ferror(file);
+    return fclose(file) == 0 && ok;
+}
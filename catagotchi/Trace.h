@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <box2d/box2d.h>
+
+/**
+ * @file Trace.h
+ * @brief Begin/end event tracing written as Chrome / Perfetto trace JSON
+ *
+ * Every thread that records events gets its own fixed ring of events the
+ * first time it records one. Only that thread writes its ring, so recording
+ * is two plain stores and one release store, no locks and no allocation.
+ * traceWrite() may be called from any thread at any time: it copies each
+ * ring up to the last published event and skips the events the owner
+ * overwrote while they were being copied.
+ *
+ * Tracing is off until traceEnable(true); while it is off a TraceScope
+ * costs one relaxed atomic load. Open the file in chrome://tracing or
+ * https://ui.perfetto.dev.
+ */
+
+// Events kept per thread, older ones are overwritten (power of two)
+constexpr uint32_t TRACE_EVENTS_PER_THREAD = 1u << 16;
+// Threads that can record, later threads are not traced
+constexpr int TRACE_MAX_THREADS = 96;
+
+extern std::atomic<bool> traceOn;
+
+/** @brief True while events are being recorded */
+inline bool traceEnabled() { return traceOn.load(std::memory_order_relaxed); }
+
+void traceEnable(bool enabled);
+void traceThread(const char* name);
+void traceBegin(const char* name, int64_t timestamp);
+void traceEnd(const char* name, int64_t timestamp);
+void traceWorldStep(b2WorldId worldId, int64_t start, int64_t end);
+bool traceWrite(const char* path);
+int64_t traceNow();
+
+/**
+ * @brief Records a begin event when constructed and the end event when destroyed
+ * @param name String literal, it is stored as a pointer
+ */
+struct TraceScope {
+    const char* name;
+    bool active;
+
+    explicit TraceScope(const char* name) : name(name), active(traceEnabled()) {
+        if (active) traceBegin(name, traceNow());
+    }
+    ~TraceScope() {
+        if (active) traceEnd(name, traceNow());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
@@ -0,0 +1,247 @@
+#include "WorldSave.h"
+#include "Trace.h"
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file WorldSave.cpp
+ * @brief Implementation of the world save file, its mapping and the saver thread
+ */
+
+namespace {
+
+    /**
+     * @brief Size a file with these record counts must have
+     */
+    size_t expectedSize(const WorldSaveHeader& header) {
+        return sizeof(WorldSaveHeader) + (size_t)header.catCount * sizeof(SavedCat) +
+            (size_t)header.foodCount * sizeof(SavedFood) + (size_t)header.poopCount * sizeof(SavedPoop);
+    }
+
+}
+
+/**
+ * @brief Write a captured world to disk atomically
+ * @param save Captured world
+ * @param path Save file, replaced only once the new file is complete
+ * @return False if writing failed, the old save is then left untouched
+ */
+bool writeWorldSave(const WorldSave& save, const char* path) {
+    std::string tempPath = std::string(path) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+
+    WorldSaveHeader header = save.header;
+    header.catCount = (int32_t)save.cats.size();
+    header.foodCount = (int32_t)save.foods.size();
+    header.poopCount = (int32_t)save.poops.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(save.cats.data(), sizeof(SavedCat), save.cats.size(), file) == save.cats.size();
+    ok = ok && fwrite(save.foods.data(), sizeof(SavedFood), save.foods.size(), file) == save.foods.size();
+    ok = ok && fwrite(save.poops.data(), sizeof(SavedPoop), save.poops.size(), file) == save.poops.size();
+    ok = ok && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = (fclose(file) == 0) && ok;
+
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tempPath.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = ok && rename(tempPath.c_str(), path) == 0;
+#endif
+    if (!ok) remove(tempPath.c_str());
+    return ok;
+}
+
+/**
+ * @brief Unmaps the file if it is still mapped
+ */
+MappedWorldSave::~MappedWorldSave() {
+    close();
+}
+
+/**
+ * @brief Map a save file and check that it is complete
+ * @param path Save file
+ * @return False if the file is missing, of another version or truncated
+ */
+bool MappedWorldSave::open(const char* path) {
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    HANDLE m = GetFileSizeEx(f, &fileSize) && fileSize.QuadPart > 0
+        ? CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void* view = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    file = f;
+    mapping = m;
+    data = static_cast<const unsigned char*>(view);
+    size = (size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    data = static_cast<const unsigned char*>(view);
+    size = (size_t)st.st_size;
+#endif
+
+    WorldSaveHeader expected;
+    bool valid = size >= sizeof(WorldSaveHeader) &&
+        memcmp(header().magic, expected.magic, sizeof(expected.magic)) == 0 &&
+        header().version == expected.version &&
+        header().catCount >= 0 && header().foodCount >= 0 && header().poopCount >= 0 &&
+        size == expectedSize(header());
+    if (!valid) close();
+    return valid;
+}
+
+/**
+ * @brief Unmap the file
+ */
+void MappedWorldSave::close() {
+    if (!data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+/**
+ * @brief Cat records, header().catCount of them
+ */
+const SavedCat* MappedWorldSave::cats() const {
+    return reinterpret_cast<const SavedCat*>(data + sizeof(WorldSaveHeader));
+}
+
+/**
+ * @brief Food records, header().foodCount of them
+ */
+const SavedFood* MappedWorldSave::foods() const {
+    return reinterpret_cast<const SavedFood*>(cats() + header().catCount);
+}
+
+/**
+ * @brief Poop records, header().poopCount of them
+ */
+const SavedPoop* MappedWorldSave::poops() const {
+    return reinterpret_cast<const SavedPoop*>(foods() + header().foodCount);
+}
+
+/**
+ * @brief Starts the saver thread
+ * @param path Save file to write to
+ */
+WorldSaver::WorldSaver(const char* path) : savePath(path) {
+    thread = std::thread(&WorldSaver::run, this);
+}
+
+/**
+ * @brief Writes a pending save and stops the thread
+ */
+WorldSaver::~WorldSaver() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+/**
+ * @brief Get the buffer to capture the world into, never blocks
+ * @return The buffer, or nullptr while the previous save is still in progress
+ */
+WorldSave* WorldSaver::beginCapture() {
+    std::unique_lock<std::mutex> lock(mu, std::try_to_lock);
+    if (!lock.owns_lock() || pending || writing) return nullptr;
+    return &buffer;
+}
+
+/**
+ * @brief Get the buffer to capture the world into, waiting for the previous save
+ * @return The buffer, or nullptr if the saver is shutting down
+ *
+ * For the final save at exit, where beginCapture() could give up on a busy
+ * or spuriously failing lock and lose the last minutes of play.
+ */
+WorldSave* WorldSaver::waitCapture() {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [this] { return stopping || (!pending && !writing); });
+    return stopping ? nullptr : &buffer;
+}
+
+/**
+ * @brief Hand the captured buffer to the saver thread
+ */
+void WorldSaver::submit() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        pending = true;
+    }
+    cv.notify_all();
+}
+
+/**
+ * @brief Wait until nothing is pending or being written
+ */
+void WorldSaver::finish() {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [this] { return !pending && !writing; });
+}
+
+/**
+ * @brief The thread body: write each submitted capture
+ */
+void WorldSaver::run() {
+    traceThread("saver");
+    std::unique_lock<std::mutex> lock(mu);
+    for (;;) {
+        cv.wait(lock, [this] { return pending || stopping; });
+        if (!pending) return;
+
+        pending = false;
+        writing = true;
+        lock.unlock();
+        bool ok;
+        {
+            TraceScope trace("save write");
+            ok = writeWorldSave(buffer, savePath.c_str());
+        }
+        (ok ? written : failed)++;
+        lock.lock();
+        writing = false;
+        cv.notify_all();
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file WorldSave.h
+ * @brief Versioned binary save file of a GameWorld
+ *
+ * The file is a WorldSaveHeader followed by the cat, food and poop records
+ * as plain arrays, so loading maps the file and creates bodies straight from
+ * the mapped records without parsing. Files are written to a temporary name
+ * and renamed over the old save, so a crash never leaves half a save behind.
+ *
+ * Saving while the game runs is split in two: the physics thread copies the
+ * body state into a WorldSave between two steps (capture) and the
+ * WorldSaver thread does the slow part (writing the file).
+ */
+
+// Box2D body state, enough to put a body back exactly where it was
+struct SavedBody {
+    float x, y;
+    float cosAngle, sinAngle;
+    float vx, vy;
+    float angularVelocity;
+    uint8_t awake;
+    uint8_t pad[3];
+};
+
+struct SavedCat {
+    SavedBody body;
+    int32_t eaten;
+    uint8_t state;
+    uint8_t pad[3];
+};
+
+struct SavedFood {
+    SavedBody body;
+};
+
+struct SavedPoop {
+    float x, y;
+};
+
+struct WorldSaveHeader {
+    char magic[4] = { 'C', 'A', 'T', 'W' };
+    uint32_t version = 1;
+    uint32_t seed = 0;
+    uint32_t rngState = 0;
+    float worldWidth = 0.0f;
+    float worldHeight = 0.0f;
+    int32_t spawnHeight = 0;
+    int32_t catCount = 0;
+    int32_t foodCount = 0;
+    int32_t poopCount = 0;
+    int64_t meals = 0;
+    int64_t poopsMade = 0;
+    int64_t poopsCleaned = 0;
+};
+
+static_assert(sizeof(SavedBody) == 32, "save format changed");
+static_assert(sizeof(SavedCat) == 40, "save format changed");
+static_assert(sizeof(WorldSaveHeader) == 64, "save format changed");
+
+/**
+ * @brief A captured world, filled by GameWorld::capture
+ */
+struct WorldSave {
+    WorldSaveHeader header;
+    std::vector<SavedCat> cats;
+    std::vector<SavedFood> foods;
+    std::vector<SavedPoop> poops;
+};
+
+bool writeWorldSave(const WorldSave& save, const char* path);
+
+/**
+ * @brief Read-only memory mapping of a save file
+ *
+ * The record pointers point into the mapping and stay valid until close().
+ */
+class MappedWorldSave {
+public:
+    MappedWorldSave() = default;
+    ~MappedWorldSave();
+
+    MappedWorldSave(const MappedWorldSave&) = delete;
+    MappedWorldSave& operator=(const MappedWorldSave&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const WorldSaveHeader& header() const { return *reinterpret_cast<const WorldSaveHeader*>(data); }
+    const SavedCat* cats() const;
+    const SavedFood* foods() const;
+    const SavedPoop* poops() const;
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+/**
+ * @brief Background thread writing captured worlds to disk
+ *
+ * The physics thread asks for the capture buffer with beginCapture(), which
+ * never blocks: if the previous save is still being written it gets nullptr
+ * and simply tries again after its next step.
+ */
+class WorldSaver {
+public:
+    explicit WorldSaver(const char* path);
+    ~WorldSaver();
+
+    WorldSaver(const WorldSaver&) = delete;
+    WorldSaver& operator=(const WorldSaver&) = delete;
+
+    WorldSave* beginCapture();
+    WorldSave* waitCapture();
+    void submit();
+    void finish();
+
+    const char* path() const { return savePath.c_str(); }
+    long long saves() const { return written.load(); }
+    long long failures() const { return failed.load(); }
+
+private:
+    std::string savePath;
+    WorldSave buffer;
+
+    std::thread thread;
+    std::mutex mu;
+    std::condition_variable cv;
+    bool pending = false;
+    bool writing = false;
+    bool stopping = false;
+    std::atomic<long long> written{ 0 };
+    std::atomic<long long> failed{ 0 };
+
+    void run();
+};
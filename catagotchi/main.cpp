@@ -2,18 +2,29 @@
 #include <curses.h>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
+#include <ctime>
 #include <memory>
 #include <atomic>
-#include <chrono>
 #include <thread>
 #include "Catagotchi.h"
+#include "GameWorld.h"
 #include "Physics.h"
 #include "InputHandler.h"
+#include "Renderer.h"
+#include "RenderPacer.h"
+#include "PerfOverlay.h"
+#include "Trace.h"
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include "Headless.h"
+#include "Farm.h"
 #include "Assets.h"
 
-std::mutex worldMu;
+int main(int argc, char** argv) {
+    // Count Box2D's memory per world, before any world exists
+    memoryInstall();
 
-int main() {
     // Calculate title width to match screen width wid it
     int ascii_height = CATAGOTCHI_ASCII_HEIGHT;
     int ascii_width = 0;
@@ -22,84 +33,204 @@ int main() {
         if (len > ascii_width) ascii_width = len;
     }
 
+    // Command line: [--workers=N] [--cats=N] [--seed=N] [--record=FILE] [--save=FILE] [--trace=FILE] [--fps=N] [--physics-rate=N] [--rows=N] [--cols=N]
+    //           or: [--workers=N] [--cats=N] [--seed=N] [--record=FILE] [--save=FILE] [--trace=FILE] --headless [--ticks=N] [--seconds=S] [--feed=N] [--pellets=N] [--rows=N] [--cols=N]
+    //           or: [--workers=N] --replay=FILE
+    //           or: --farm=N [--threads=N] [--cats=N] [--seed=N] [--ticks=N] [--seconds=S] [--feed=N] [--pellets=N] [--rows=N] [--cols=N]
+    //           or: --bench=food [--rate=N] [--seconds=S]
+    //           or: --check=controls
+    bool headless = false;
+    bool benchFood = false;
+    bool checkControls = false;
+    int benchRate = 10000;
+    int targetFps = 20;
+    float physicsRate = 60.0f;
+    bool seeded = false;
+    bool rowsGiven = false;
+    const char* replayPath = nullptr;
+    int farmWorlds = 0;
+    int farmThreads = (int)std::thread::hardware_concurrency();
+    HeadlessOptions headlessOptions;
+    headlessOptions.worldWidth = (float)ascii_width;
+    headlessOptions.spawnHeight = ascii_height;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--headless") == 0) headless = true;
+        else if (strcmp(arg, "--bench=food") == 0) benchFood = true;
+        else if (strcmp(arg, "--check=controls") == 0) checkControls = true;
+        else if (strncmp(arg, "--rate=", 7) == 0) benchRate = atoi(arg + 7);
+        else if (strncmp(arg, "--ticks=", 8) == 0) headlessOptions.ticks = atoll(arg + 8);
+        else if (strncmp(arg, "--seconds=", 10) == 0) headlessOptions.seconds = atof(arg + 10);
+        else if (strncmp(arg, "--feed=", 7) == 0) headlessOptions.feedInterval = atoi(arg + 7);
+        else if (strncmp(arg, "--pellets=", 10) == 0) headlessOptions.pellets = atoi(arg + 10);
+        else if (strncmp(arg, "--rows=", 7) == 0) { headlessOptions.worldHeight = (float)atoi(arg + 7); rowsGiven = true; }
+        else if (strncmp(arg, "--cols=", 7) == 0) headlessOptions.worldWidth = (float)atoi(arg + 7);
+        else if (strncmp(arg, "--workers=", 10) == 0) headlessOptions.workers = atoi(arg + 10);
+        else if (strncmp(arg, "--cats=", 7) == 0) headlessOptions.cats = atoi(arg + 7);
+        else if (strncmp(arg, "--fps=", 6) == 0) targetFps = atoi(arg + 6);
+        else if (strncmp(arg, "--physics-rate=", 15) == 0) physicsRate = (float)atof(arg + 15);
+        else if (strncmp(arg, "--seed=", 7) == 0) { headlessOptions.seed = (uint32_t)strtoul(arg + 7, nullptr, 10); seeded = true; }
+        else if (strncmp(arg, "--record=", 9) == 0) headlessOptions.record = arg + 9;
+        else if (strncmp(arg, "--replay=", 9) == 0) replayPath = arg + 9;
+        else if (strncmp(arg, "--save=", 7) == 0) headlessOptions.save = arg + 7;
+        else if (strncmp(arg, "--trace=", 8) == 0) headlessOptions.trace = arg + 8;
+        else if (strncmp(arg, "--farm=", 7) == 0) farmWorlds = atoi(arg + 7);
+        else if (strncmp(arg, "--threads=", 10) == 0) farmThreads = atoi(arg + 10);
+    }
+    int minRows = headlessOptions.spawnHeight + GAME_WORLD_MIN_ROWS_BELOW_SPAWN;
+    if (headlessOptions.worldWidth < GAME_WORLD_MIN_WIDTH) {
+        fprintf(stderr, "--cols: the world needs at least %d columns\n", GAME_WORLD_MIN_WIDTH);
+        return 1;
+    }
+    if (rowsGiven && headlessOptions.worldHeight < minRows) {
+        fprintf(stderr, "--rows: the world needs at least %d rows\n", minRows);
+        return 1;
+    }
+    if (checkControls) return runControlsCheck();
+    if (benchFood) return runFoodPoolBenchmark(benchRate, headlessOptions.seconds > 0.0 ? headlessOptions.seconds : 10.0);
+    if (replayPath) return runReplay(replayPath, headlessOptions.workers);
+    if (farmWorlds > 0) return runFarm(headlessOptions, farmWorlds, farmThreads);
+    if (headless) return runHeadless(headlessOptions);
+
     // PDCurses basic callz
     initscr();
+    cbreak();
     noecho();
     curs_set(FALSE);
-    nodelay(stdscr, TRUE);
+    typeahead(-1);   // keys are read by the input thread, curses never reads stdin
 
-    // calculate correct offsets etc for PDCurses printing, and also world dimensions fo Box2D
+    // World dimensions fo Box2D: the title width and the terminal height unless
+    // --cols/--rows ask for more, the camera scrolls over bigger worlds
     int termRows = 0, termCols = 0;
     getmaxyx(stdscr, termRows, termCols);
-    int virtualCols = ascii_width;
-    int xOffset = (termCols - virtualCols) / 2;
-    float worldWidth = (float)virtualCols;
-    float worldHeight = (float)termRows;
-
-    // Box2D World initialization
-    b2WorldDef wdef = b2DefaultWorldDef();
-    wdef.gravity = { 0.0f, 10.0f };
-    b2WorldId worldId = b2CreateWorld(&wdef);
-
-    // Ground initialization
-    {
-        std::lock_guard<std::mutex> lock(worldMu);
-        b2BodyDef gbd = b2DefaultBodyDef();
-        gbd.type = b2_staticBody;
-        gbd.position = { worldWidth * 0.5f, worldHeight - 1.0f };
-        b2BodyId groundId = b2CreateBody(worldId, &gbd);
-        b2Polygon groundBox = b2MakeBox(worldWidth * 0.5f, 1.0f);
-        b2ShapeDef gsd = b2DefaultShapeDef();
-        b2ShapeId groundShape = b2CreatePolygonShape(groundId, &gsd, &groundBox);
-        b2Shape_SetFriction(groundShape, 0.8f);
+    float worldWidth = headlessOptions.worldWidth;
+    float worldHeight = rowsGiven ? headlessOptions.worldHeight : (float)std::max(termRows, minRows);
+
+    // Box2D world with ground and cat, or the pets from the last save
+    TaskScheduler scheduler(headlessOptions.workers);
+    GameWorld world;
+    MappedWorldSave saved;
+    bool restored = headlessOptions.save && saved.open(headlessOptions.save);
+    if (restored) {
+        world.restore(saved, &scheduler);
+        saved.close();
+    }
+    else {
+        world.create(worldWidth, worldHeight, ascii_height, &scheduler, headlessOptions.cats);
+        world.seedRandom(seeded ? headlessOptions.seed : (uint32_t)time(nullptr));
     }
 
-    // Cat spawnage
-    CatPtr cat = Cat::spawn(worldId, worldWidth * 0.5f, worldHeight - 2.0f);
-    FoodPtr food = nullptr;
-    PoopPtr poop = nullptr;
+    // Optional session recording for --replay, replays always start from a new world
+    SessionRecorder recorder;
+    if (headlessOptions.record && !restored) recorder.open(headlessOptions.record, world.sessionHeader());
+    std::unique_ptr<WorldSaver> saver;
+    if (headlessOptions.save) saver = std::make_unique<WorldSaver>(headlessOptions.save);
+
+    // Record the physics, render and input timelines for --trace
+    traceThread("render");
+    if (headlessOptions.trace) traceEnable(true);
 
     // start the main loop and physics thread
     std::atomic<bool> running{ true };
-    startPhysicsThread(worldId, running, worldMu);
-
-    // Lastly, create the input handler class (moved these to a seperate script to shorten main function)
-    InputHandler inputHandler(cat, food, poop, worldId, worldMu, virtualCols, ascii_height);
+    TripleBuffer<RenderSnapshot> snapshots;
+    CommandQueue commands;
+    PhysicsService physics(world, snapshots, commands);
+    if (recorder.isOpen()) physics.setRecorder(&recorder);
+    physics.setSaver(saver.get());
+    physics.setTargetRate(b2ClampFloat(physicsRate, PHYSICS_MIN_RATE, PHYSICS_MAX_RATE));
+    physics.start();
+
+    // Lastly, start the input thread (moved these to a seperate script to shorten main function)
+    InputHandler inputHandler(commands, running);
+    inputHandler.setTracePath(headlessOptions.trace);
+    inputHandler.setPhysics(&physics);
+    inputHandler.start();
+    Renderer renderer(CATAGOTCHI_ASCII, ascii_height, ascii_width);
+    RenderPacer pacer(targetFps);
+    PerfOverlay perfOverlay;
+    bool perfShown = false;
+    FrameArena frameArena;
+    long long drawnVersion = 0;   // snapshots start at 0 before the first step
 
     while (running.load()) {
-        clear();
+        pacer.beginFrame();
+
+        // The physics thread only profiles while the overlay is up
+        bool showPerf = inputHandler.overlayShown();
+        if (showPerf != perfShown) {
+            perfShown = showPerf;
+            physics.setProfiling(showPerf);
+            if (!showPerf) {
+                perfOverlay.reset();
+                renderer.setOverlay(nullptr, 0);
+            }
+        }
+
+        // The physics thread only snapshots what fits the terminal
         getmaxyx(stdscr, termRows, termCols);
-
-        // ASCII title
-        for (int i = 0; i < ascii_height; ++i)
-            mvprintw(i, xOffset, "%s", CATAGOTCHI_ASCII[i]);
-        for (int c = 0; c < virtualCols; ++c)
-            mvaddch(termRows - 2, xOffset + c, '-');
-
-        // Draw foodz and poopz
-        if (poop) poop->draw(xOffset, termRows);
-        if (food) food->draw(xOffset, termRows);
-
-        // Cat AI
-        cat->moveToward(food, poop, worldWidth);
-        cat->tryEat(food, poop, worldId, worldWidth);
-        cat->draw(xOffset, termCols, termRows);
-
-        // Draw commands in the bottom of the screen
-        if (poop && poop->active)
-            mvprintw(termRows - 1, xOffset, "Commands: q=quit  f=feed  c=clean poop");
-        else
-            mvprintw(termRows - 1, xOffset, "Commands: q=quit  f=feed");
-
-        refresh();
-
-        // Call for input handling
-        inputHandler.handleInput(running);
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        physics.setViewport(termCols, termRows, inputHandler.selectedCat());
+
+        // Latest frame from the physics thread, the world itself is never read
+        // here. Drawn only if its content changed since the last drawn one.
+        snapshots.update();
+        const RenderSnapshot& frame = snapshots.readBuffer();
+        bool fresh = frame.contentVersion != drawnVersion;
+        if (fresh) {
+            TraceScope trace("draw");
+            if (perfShown) perfOverlay.beginRender();
+            renderer.draw(frame);
+            if (perfShown) perfOverlay.endRender();
+            drawnVersion = frame.contentVersion;
+        }
+        if (perfShown && perfOverlay.update(frame.perf, physics.stats(), memoryStats(world.memoryTag), frameArena)) {
+            TraceScope trace("overlay");
+            renderer.setOverlay(perfOverlay.lines(), PerfOverlay::LINES);
+        }
+
+        frameArena.reset();
+        pacer.endFrame(fresh);
     }
 
+    inputHandler.stop();
     endwin();
-    b2DestroyWorld(worldId);
+    physics.stop();
+
+    // Final save, after any autosave still being written
+    if (saver) {
+        if (WorldSave* save = saver->waitCapture()) {
+            world.capture(*save);
+            saver->submit();
+            saver->finish();
+        }
+        else fprintf(stderr, "save: the final save to %s could not be captured\n", saver->path());
+    }
+    world.destroy();
+    if (headlessOptions.trace) {
+        traceEnable(false);
+        if (traceWrite(headlessOptions.trace))
+            printf("trace: written to %s (and %lld times with t)\n", headlessOptions.trace, inputHandler.tracesWritten());
+        else fprintf(stderr, "trace: cannot write %s\n", headlessOptions.trace);
+    }
+
+    pacer.report(stdout);
+    const PhysicsStats& physicsStats = physics.stats();
+    printf("physics: %lld steps, %.1f steps/s in the last second (target %.1f), %lld overruns, %.2f ms behind at exit\n",
+        physicsStats.stepCount.load(), physicsStats.stepRate.load(), physics.targetRate(),
+        physicsStats.overruns.load(), physicsStats.lagMs.load());
+    printf("  step time avg %.3f ms, p99 %.3f ms in the last second, %d awake bodies\n",
+        physicsStats.avgStepMs.load(), physicsStats.p99StepMs.load(), physicsStats.awakeBodies.load());
+    printf("physics: %lld heap allocations in %lld of %lld steps, the last in step %lld\n",
+        physicsStats.heapAllocations.load(), physicsStats.allocatingSteps.load(),
+        physicsStats.stepCount.load(), physicsStats.lastAllocatingStep.load());
+    world.commandLatency.report(stdout);
+    if (headlessOptions.record) {
+        if (restored) fprintf(stderr, "record: not recorded, the world was restored from %s\n", headlessOptions.save);
+        else if (recorder.isOpen()) printf("record: %lld steps written to %s\n", recorder.steps(), headlessOptions.record);
+        else fprintf(stderr, "record: cannot write %s\n", headlessOptions.record);
+    }
+    if (saver) {
+        if (saver->failures() > 0) fprintf(stderr, "save: %lld saves to %s failed\n", saver->failures(), saver->path());
+        else printf("save: world saved to %s\n", saver->path());
+    }
     return 0;
 }
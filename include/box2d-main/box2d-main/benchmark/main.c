@@ -154,6 +154,9 @@ int main( int argc, char** argv )
 		{ "smash", CreateSmash, NULL, 300 },
 		{ "spinner", CreateSpinner, StepSpinner, 1400 },
 		{ "tumbler", CreateTumbler, NULL, 750 },
+		{ "cat_colony", CreateCatColony, StepCatColony, 1000 },
+		{ "food_downpour", CreateFoodDownpour, StepFoodDownpour, 1000 },
+		{ "poop_field", CreatePoopField, StepPoopField, 1000 },
 	};
 
 	int benchmarkCount = ARRAY_COUNT( benchmarks );
@@ -1645,6 +1645,108 @@ public:
 
 static int benchmarkRain = RegisterSample( "Benchmark", "Rain", BenchmarkRain::Create );
 
+class BenchmarkCatColony : public Sample
+{
+public:
+	explicit BenchmarkCatColony( SampleContext* context )
+		: Sample( context )
+	{
+		if ( m_context->restart == false )
+		{
+			m_context->camera.m_center = { 0.0f, 10.0f };
+			m_context->camera.m_zoom = 60.0f;
+			m_context->enableSleep = true;
+		}
+
+		CreateCatColony( m_worldId );
+	}
+
+	void Step() override
+	{
+		if ( m_context->pause == false || m_context->singleStep == true )
+		{
+			StepCatColony( m_worldId, m_stepCount );
+		}
+
+		Sample::Step();
+	}
+
+	static Sample* Create( SampleContext* context )
+	{
+		return new BenchmarkCatColony( context );
+	}
+};
+
+static int benchmarkCatColony = RegisterSample( "Benchmark", "Cat Colony", BenchmarkCatColony::Create );
+
+class BenchmarkFoodDownpour : public Sample
+{
+public:
+	explicit BenchmarkFoodDownpour( SampleContext* context )
+		: Sample( context )
+	{
+		if ( m_context->restart == false )
+		{
+			m_context->camera.m_center = { 0.0f, 10.0f };
+			m_context->camera.m_zoom = 60.0f;
+			m_context->enableSleep = true;
+		}
+
+		CreateFoodDownpour( m_worldId );
+	}
+
+	void Step() override
+	{
+		if ( m_context->pause == false || m_context->singleStep == true )
+		{
+			StepFoodDownpour( m_worldId, m_stepCount );
+		}
+
+		Sample::Step();
+	}
+
+	static Sample* Create( SampleContext* context )
+	{
+		return new BenchmarkFoodDownpour( context );
+	}
+};
+
+static int benchmarkFoodDownpour = RegisterSample( "Benchmark", "Food Downpour", BenchmarkFoodDownpour::Create );
+
+class BenchmarkPoopField : public Sample
+{
+public:
+	explicit BenchmarkPoopField( SampleContext* context )
+		: Sample( context )
+	{
+		if ( m_context->restart == false )
+		{
+			m_context->camera.m_center = { 0.0f, 10.0f };
+			m_context->camera.m_zoom = 60.0f;
+			m_context->enableSleep = true;
+		}
+
+		CreatePoopField( m_worldId );
+	}
+
+	void Step() override
+	{
+		if ( m_context->pause == false || m_context->singleStep == true )
+		{
+			StepPoopField( m_worldId, m_stepCount );
+		}
+
+		Sample::Step();
+	}
+
+	static Sample* Create( SampleContext* context )
+	{
+		return new BenchmarkPoopField( context );
+	}
+};
+
+static int benchmarkPoopField = RegisterSample( "Benchmark", "Poop Field", BenchmarkPoopField::Create );
+
 class BenchmarkShapeDistance : public Sample
 {
 public:
@@ -4,6 +4,7 @@
 #include "benchmarks.h"
 
 #include "human.h"
+#include "random.h"
 
 #include "box2d/box2d.h"
 
@@ -681,3 +682,278 @@ void CreateWasher( b2WorldId worldId, bool kinematic )
 		y += 2.1f * a;
 	}
 }
+
+// Catagotchi scenes: cats are boxes with a mouth sensor walking on a floor, food is small boxes
+// that fall onto it and poop is small static boxes left on the floor.
+
+static void CreateCatagotchiFloor( b2WorldId worldId, float width )
+{
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.position = (b2Vec2){ 0.0f, -1.0f };
+	b2BodyId groundId = b2CreateBody( worldId, &bodyDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.material.friction = 0.8f;
+	b2Polygon box = b2MakeBox( 0.5f * width, 1.0f );
+	b2CreatePolygonShape( groundId, &shapeDef, &box );
+}
+
+static b2BodyId CreateCatagotchiCat( b2WorldId worldId, b2Vec2 position )
+{
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position = position;
+	b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.density = 3.0f;
+	shapeDef.material.friction = 0.3f;
+	b2Polygon body = b2MakeBox( 2.0f, 0.5f );
+	b2CreatePolygonShape( bodyId, &shapeDef, &body );
+
+	// Mouth
+	shapeDef = b2DefaultShapeDef();
+	shapeDef.density = 0.0f;
+	shapeDef.isSensor = true;
+	shapeDef.enableSensorEvents = true;
+	b2Polygon mouth = b2MakeBox( 4.0f, 2.0f );
+	b2CreatePolygonShape( bodyId, &shapeDef, &mouth );
+
+	return bodyId;
+}
+
+static b2BodyId CreateCatagotchiFood( b2WorldId worldId, b2Vec2 position, int index )
+{
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	bodyDef.type = b2_dynamicBody;
+	bodyDef.position = position;
+	bodyDef.userData = (void*)(intptr_t)( index + 1 );
+	b2BodyId bodyId = b2CreateBody( worldId, &bodyDef );
+
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	shapeDef.density = 0.8f;
+	shapeDef.material.friction = 0.3f;
+	shapeDef.enableSensorEvents = true;
+	b2Polygon box = b2MakeBox( 0.5f, 0.5f );
+	b2CreatePolygonShape( bodyId, &shapeDef, &box );
+
+	return bodyId;
+}
+
+#define CAT_COLONY_MAX_CATS 1000
+#define CAT_COLONY_MAX_FOOD 500
+
+typedef struct CatColonyData
+{
+	b2BodyId cats[CAT_COLONY_MAX_CATS];
+	b2BodyId foods[CAT_COLONY_MAX_FOOD];
+	b2Vec2 foodPositions[CAT_COLONY_MAX_FOOD];
+	int catCount;
+	int foodCount;
+	float width;
+} CatColonyData;
+
+CatColonyData g_catColonyData;
+
+static b2Vec2 RandomFoodDrop( float width )
+{
+	return (b2Vec2){ RandomFloatRange( -0.45f * width, 0.45f * width ), RandomFloatRange( 15.0f, 25.0f ) };
+}
+
+void CreateCatColony( b2WorldId worldId )
+{
+	g_randomSeed = RAND_SEED;
+
+	CatColonyData* data = &g_catColonyData;
+	data->catCount = BENCHMARK_DEBUG ? 50 : CAT_COLONY_MAX_CATS;
+	data->foodCount = data->catCount / 2;
+	data->width = 6.0f * data->catCount;
+
+	CreateCatagotchiFloor( worldId, data->width );
+
+	for ( int i = 0; i < data->catCount; ++i )
+	{
+		float x = -0.5f * data->width + 6.0f * ( i + 0.5f );
+		data->cats[i] = CreateCatagotchiCat( worldId, (b2Vec2){ x, 0.5f } );
+	}
+
+	for ( int i = 0; i < data->foodCount; ++i )
+	{
+		data->foods[i] = CreateCatagotchiFood( worldId, RandomFoodDrop( data->width ), i );
+	}
+}
+
+// Every cat chases a pellet, eaten pellets drop again somewhere else
+float StepCatColony( b2WorldId worldId, int stepCount )
+{
+	(void)stepCount;
+	CatColonyData* data = &g_catColonyData;
+
+	b2SensorEvents events = b2World_GetSensorEvents( worldId );
+	for ( int i = 0; i < events.beginCount; ++i )
+	{
+		b2ShapeId visitorId = events.beginEvents[i].visitorShapeId;
+		if ( b2Shape_IsValid( visitorId ) == false )
+		{
+			continue;
+		}
+
+		b2BodyId bodyId = b2Shape_GetBody( visitorId );
+		int index = (int)(intptr_t)b2Body_GetUserData( bodyId ) - 1;
+		if ( 0 <= index && index < data->foodCount )
+		{
+			b2Body_SetTransform( bodyId, RandomFoodDrop( data->width ), b2Rot_identity );
+			b2Body_SetLinearVelocity( bodyId, b2Vec2_zero );
+		}
+	}
+
+	for ( int i = 0; i < data->foodCount; ++i )
+	{
+		data->foodPositions[i] = b2Body_GetPosition( data->foods[i] );
+	}
+
+	for ( int i = 0; i < data->catCount; ++i )
+	{
+		b2BodyId catId = data->cats[i];
+		b2Vec2 target = data->foodPositions[i % data->foodCount];
+		float dx = b2ClampFloat( target.x - b2Body_GetPosition( catId ).x, -4.0f, 4.0f );
+		b2Body_SetLinearVelocity( catId, (b2Vec2){ 1.5f * dx, b2Body_GetLinearVelocity( catId ).y } );
+	}
+
+	return 0.0f;
+}
+
+#define FOOD_DOWNPOUR_MAX_CATS 1000
+#define FOOD_DOWNPOUR_MAX_FOOD 4000
+
+typedef struct FoodDownpourData
+{
+	b2BodyId foods[FOOD_DOWNPOUR_MAX_FOOD];
+	int foodCapacity;
+	int foodCount;
+	int oldest;
+	float width;
+} FoodDownpourData;
+
+FoodDownpourData g_foodDownpourData;
+
+void CreateFoodDownpour( b2WorldId worldId )
+{
+	g_randomSeed = RAND_SEED;
+
+	FoodDownpourData* data = &g_foodDownpourData;
+	int catCount = BENCHMARK_DEBUG ? 50 : FOOD_DOWNPOUR_MAX_CATS;
+	data->foodCapacity = BENCHMARK_DEBUG ? 200 : FOOD_DOWNPOUR_MAX_FOOD;
+	data->foodCount = 0;
+	data->oldest = 0;
+
+	// Cats almost shoulder to shoulder
+	data->width = 4.5f * catCount;
+	CreateCatagotchiFloor( worldId, data->width );
+
+	for ( int i = 0; i < catCount; ++i )
+	{
+		float x = -0.5f * data->width + 4.5f * ( i + 0.5f );
+		CreateCatagotchiCat( worldId, (b2Vec2){ x, 0.5f } );
+	}
+}
+
+// Drops pellets every step, destroying the oldest once the capacity is reached
+float StepFoodDownpour( b2WorldId worldId, int stepCount )
+{
+	(void)stepCount;
+	FoodDownpourData* data = &g_foodDownpourData;
+
+	int dropCount = BENCHMARK_DEBUG ? 2 : 8;
+	for ( int i = 0; i < dropCount; ++i )
+	{
+		int index;
+		if ( data->foodCount < data->foodCapacity )
+		{
+			index = data->foodCount++;
+		}
+		else
+		{
+			index = data->oldest;
+			data->oldest = ( data->oldest + 1 ) % data->foodCapacity;
+			b2DestroyBody( data->foods[index] );
+		}
+
+		data->foods[index] = CreateCatagotchiFood( worldId, RandomFoodDrop( data->width ), index );
+	}
+
+	return 0.0f;
+}
+
+#define POOP_FIELD_MAX_CATS 500
+#define POOP_FIELD_MAX_POOP 8000
+
+typedef struct PoopFieldData
+{
+	b2BodyId cats[POOP_FIELD_MAX_CATS];
+	b2BodyId poops[POOP_FIELD_MAX_POOP];
+	int catCount;
+	int poopCapacity;
+	int poopCount;
+	float width;
+} PoopFieldData;
+
+PoopFieldData g_poopFieldData;
+
+void CreatePoopField( b2WorldId worldId )
+{
+	PoopFieldData* data = &g_poopFieldData;
+	data->catCount = BENCHMARK_DEBUG ? 50 : POOP_FIELD_MAX_CATS;
+	data->poopCapacity = BENCHMARK_DEBUG ? 400 : POOP_FIELD_MAX_POOP;
+	data->poopCount = 0;
+	data->width = 8.0f * data->catCount;
+
+	CreateCatagotchiFloor( worldId, data->width );
+
+	for ( int i = 0; i < data->catCount; ++i )
+	{
+		float x = -0.5f * data->width + 8.0f * ( i + 0.5f );
+		data->cats[i] = CreateCatagotchiCat( worldId, (b2Vec2){ x, 0.5f } );
+	}
+}
+
+// Cats pace back and forth leaving static poop bodies behind. When the floor is full
+// all poop is cleaned at once.
+float StepPoopField( b2WorldId worldId, int stepCount )
+{
+	PoopFieldData* data = &g_poopFieldData;
+
+	if ( data->poopCount == data->poopCapacity )
+	{
+		for ( int i = 0; i < data->poopCount; ++i )
+		{
+			b2DestroyBody( data->poops[i] );
+		}
+		data->poopCount = 0;
+	}
+
+	float speed = ( ( stepCount / 120 ) & 1 ) ? -3.0f : 3.0f;
+	int poopGroup = ( stepCount / 4 ) % 8;
+	bool poopStep = ( stepCount & 3 ) == 0;
+
+	b2BodyDef bodyDef = b2DefaultBodyDef();
+	b2ShapeDef shapeDef = b2DefaultShapeDef();
+	b2Polygon box = b2MakeBox( 0.2f, 0.2f );
+
+	for ( int i = 0; i < data->catCount; ++i )
+	{
+		b2BodyId catId = data->cats[i];
+		float vx = ( i & 1 ) ? -speed : speed;
+		b2Body_SetLinearVelocity( catId, (b2Vec2){ vx, b2Body_GetLinearVelocity( catId ).y } );
+
+		if ( poopStep && i % 8 == poopGroup && data->poopCount < data->poopCapacity )
+		{
+			bodyDef.position = (b2Vec2){ b2Body_GetPosition( catId ).x - 2.5f * vx / speed, 0.2f };
+			b2BodyId poopId = b2CreateBody( worldId, &bodyDef );
+			b2CreatePolygonShape( poopId, &shapeDef, &box );
+			data->poops[data->poopCount++] = poopId;
+		}
+	}
+
+	return 0.0f;
+}
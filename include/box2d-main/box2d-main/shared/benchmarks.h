@@ -23,6 +23,12 @@ float StepSpinner( b2WorldId worldId, int stepCount );
 void CreateSmash( b2WorldId worldId );
 void CreateTumbler( b2WorldId worldId );
 void CreateWasher( b2WorldId worldId, bool kinematic );
+void CreateCatColony( b2WorldId worldId );
+float StepCatColony( b2WorldId worldId, int stepCount );
+void CreateFoodDownpour( b2WorldId worldId );
+float StepFoodDownpour( b2WorldId worldId, int stepCount );
+void CreatePoopField( b2WorldId worldId );
+float StepPoopField( b2WorldId worldId, int stepCount );
 
 #ifdef __cplusplus
 }